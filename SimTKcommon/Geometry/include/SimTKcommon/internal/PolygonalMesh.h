@@ -221,6 +221,7 @@ public:
         - <tt>.stl </tt>: 3D Systems Stereolithography file (ascii or binary)
         - <tt>.stla</tt>: ascii-only stl extension
         - <tt>.vtp </tt>: VTK PolyData file (we can only read the ascii version)
+        - <tt>.simtkmesh</tt>: binary mesh file written by saveBinaryFile()
 
     @param[in]  pathname    The name of a mesh file with a recognized extension.
     **/
@@ -228,7 +229,9 @@ public:
 
     /** Load a Wavefront OBJ (.obj) file, adding the vertices and faces it 
     contains to this mesh, and ignoring anything else in the file. The suffix
-    for these files is typically ".obj" but we don't check here.
+    for these files is typically ".obj" but we don't check here. The file is
+    memory-mapped, and large files are split into chunks that are parsed 
+    concurrently.
     @param[in]  pathname    The name of a .obj file. **/
     void loadObjFile(const String& pathname);
 
@@ -241,7 +244,8 @@ public:
 
     /** Load a VTK PolyData (.vtp) file, adding the vertices and faces it 
     contains to this mesh and ignoring anything else in the file. The suffix 
-    for these files is typically ".vtp" but we don't check here.
+    for these files is typically ".vtp" but we don't check here. The file is
+    scanned in a single pass without building an XML document in memory.
     @param[in]  pathname    The name of a .vtp file. **/
     void loadVtpFile(const String& pathname);
 
@@ -251,10 +255,25 @@ public:
     Otherwise, including ".stl" or anything else, we'll examine the contents to 
     determine which format is used. STL files include many repeated vertices;
     we will collapse any that coincide to within a small tolerance so that there
-    is some hope of getting a connected surface.
+    is some hope of getting a connected surface. Large ascii files are parsed
+    in concurrent chunks, as for loadObjFile().
     @param[in]  pathname    The name of a .stl or .stla file. **/
     void loadStlFile(const String& pathname);
 
+    /** Load a file written by saveBinaryFile(), adding its vertices and faces
+    to this mesh. The whole file is read at once and the arrays are copied
+    straight out of it, so this is by far the fastest way to load a large
+    mesh; convert meshes you load repeatedly into this format.
+    @param[in]  pathname    The name of a .simtkmesh file. **/
+    void loadBinaryFile(const String& pathname);
+
+    /** Write this mesh to a file in Simbody's own binary mesh format, which
+    holds the vertex positions at full precision and the faces exactly as they
+    are in this mesh. The data is little-endian. The suffix should be
+    ".simtkmesh" so that loadFile() recognizes it.
+    @param[in]  pathname    The name of the file to be written. **/
+    void saveBinaryFile(const String& pathname) const;
+
 private:
     explicit PolygonalMesh(PolygonalMeshImpl* impl) : HandleBase(impl) {}
     void initializeHandleIfEmpty();
@@ -22,16 +22,39 @@
  * -------------------------------------------------------------------------- */
 
 #include "PolygonalMeshImpl.h"
-#include "SimTKcommon/internal/Xml.h"
 #include "SimTKcommon/internal/String.h"
 #include "SimTKcommon/internal/Pathname.h"
+#include "SimTKcommon/internal/ParallelExecutor.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
 #include <sstream>
 #include <string>
-#include <set>
-#include <map>
-#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #if !defined(NOMINMAX)
+    #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
 
 using namespace SimTK;
 
@@ -127,80 +150,351 @@ void PolygonalMesh::loadFile(const String& pathname) {
     if (lext==".obj") loadObjFile(pathname);
     else if (lext==".vtp") loadVtpFile(pathname);
     else if (lext==".stl"||lext==".stla") loadStlFile(pathname);
+    else if (lext==".simtkmesh") loadBinaryFile(pathname);
     else {
         SimTK_ERRCHK1_ALWAYS(!"unrecognized extension",
             "PolygonalMesh::loadFile()",
             "Unrecognized file extension on mesh file '%s':\n"
-            "  expected .obj, .stl, .stla, or .vtp.", pathname.c_str());
+            "  expected .obj, .stl, .stla, .vtp, or .simtkmesh.",
+            pathname.c_str());
+    }
+}
+
+//------------------------------------------------------------------------------
+//                               FILE CONTENTS
+//------------------------------------------------------------------------------
+// The mesh loaders work on the complete contents of a file in memory rather
+// than through an istream. Files are memory-mapped where the platform allows,
+// and large text files are split at line boundaries into chunks that are
+// tokenized concurrently; only the final assembly of the mesh is serial.
+namespace {
+
+// A read-only view of the entire contents of a file.
+class MappedFile {
+public:
+    MappedFile(const String& pathname, const char* method) {
+        #ifdef _WIN32
+        m_file = CreateFileA(pathname.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                             NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        SimTK_ERRCHK1_ALWAYS(m_file != INVALID_HANDLE_VALUE, method,
+            "Failed to open file '%s'", pathname.c_str());
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(m_file, &fileSize);
+        m_size = (std::size_t)fileSize.QuadPart;
+        if (m_size == 0) return; // can't map an empty file
+        m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (m_mapping)
+            m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ,0,0,0);
+        if (!m_data) {
+            unmap();
+            SimTK_ERRCHK1_ALWAYS(false, method,
+                "Failed to map file '%s'", pathname.c_str());
+        }
+        #else
+        const int fd = open(pathname.c_str(), O_RDONLY);
+        SimTK_ERRCHK1_ALWAYS(fd >= 0, method,
+            "Failed to open file '%s'", pathname.c_str());
+        struct stat st;
+        void* p = MAP_FAILED;
+        if (fstat(fd, &st) == 0) {
+            m_size = (std::size_t)st.st_size;
+            if (m_size > 0)
+                p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd); // the mapping keeps the file open
+        if (m_size == 0) return;
+        SimTK_ERRCHK1_ALWAYS(p != MAP_FAILED, method,
+            "Failed to map file '%s'", pathname.c_str());
+        m_data = static_cast<const char*>(p);
+        #endif
+    }
+    ~MappedFile() {unmap();}
+
+    const char* begin() const {return m_data;}
+    const char* end()   const {return m_data + m_size;}
+    std::size_t size()  const {return m_size;}
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    #ifdef _WIN32
+    void unmap() {
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+        m_data = nullptr; m_mapping = NULL; m_file = INVALID_HANDLE_VALUE;
+    }
+    HANDLE m_file = INVALID_HANDLE_VALUE, m_mapping = NULL;
+    #else
+    void unmap() {
+        if (m_data) munmap(const_cast<char*>(m_data), m_size);
+        m_data = nullptr;
+    }
+    #endif
+
+    const char* m_data = nullptr; // null if the file is empty
+    std::size_t m_size = 0;
+};
+
+// Text files are parsed in chunks of about this many bytes.
+const std::size_t ParseChunkBytes = 1 << 20;
+
+// Return the end of the line beginning at p: the '\n' or end.
+const char* findLineEnd(const char* p, const char* end) {
+    const char* e = (const char*)std::memchr(p, '\n', end-p);
+    return e ? e : end;
+}
+
+// Split [begin,end) into chunks of about ParseChunkBytes that each end just
+// after a newline. Returns the chunk boundaries, starting with begin and
+// ending with end. If lineContinuation is set, a newline preceded by a
+// backslash doesn't end a line so we won't split there.
+Array_<const char*> findLineChunks(const char* begin, const char* end,
+                                   bool lineContinuation) {
+    Array_<const char*> bounds(1, begin);
+    while ((std::size_t)(end-bounds.back()) > ParseChunkBytes) {
+        const char* p = findLineEnd(bounds.back() + ParseChunkBytes, end);
+        while (lineContinuation && p < end && p[-1] == '\\')
+            p = findLineEnd(p+1, end);
+        if (p == end) break;
+        bounds.push_back(p+1);
+    }
+    bounds.push_back(end);
+    return bounds;
+}
+
+// Runs parseChunk(c) for each chunk c, catching exceptions so that they can
+// be rethrown on the calling thread.
+template <class F>
+class ParseChunksTask : public ParallelExecutor::Task {
+public:
+    ParseChunksTask(const F& parseChunk, int numChunks)
+    :   m_parseChunk(parseChunk), m_errors(numChunks) {}
+    void execute(int chunk) override {
+        try {m_parseChunk(chunk);}
+        catch (...) {m_errors[chunk] = std::current_exception();}
+    }
+    // Rethrow the exception from the earliest chunk that failed, which is
+    // the one a serial parse would have reported.
+    void rethrowFirstError() const {
+        for (const std::exception_ptr& e : m_errors)
+            if (e) std::rethrow_exception(e);
+    }
+private:
+    const F&                        m_parseChunk;
+    std::vector<std::exception_ptr> m_errors;
+};
+
+// Call parseChunk(c) for c in [0,numChunks), concurrently if there is more
+// than one chunk and we aren't already running on a ParallelExecutor's
+// thread.
+template <class F>
+void parseChunks(int numChunks, const F& parseChunk) {
+    ParseChunksTask<F> task(parseChunk, numChunks);
+    if (numChunks > 1 && !ParallelExecutor::isWorkerThread()) {
+        ParallelExecutor executor(std::min(numChunks,
+                                           ParallelExecutor::getNumProcessors()));
+        executor.execute(task, numChunks);
+    } else {
+        for (int c=0; c < numChunks; ++c)
+            task.execute(c);
     }
+    task.rethrowFirstError();
+}
+
+// The same whitespace as operator>> skips in the "C" locale.
+bool isBlank(char c)
+{   return c==' ' || c=='\t' || c=='\n' || c=='\r' || c=='\v' || c=='\f'; }
+
+const char* skipBlanks(const char* p, const char* end)
+{   while (p < end && isBlank(*p)) ++p; return p; }
+
+const char* skipToken(const char* p, const char* end)
+{   while (p < end && !isBlank(*p)) ++p; return p; }
+
+// Copy the token at p (which must not be blank) into a null-terminated buffer
+// so that the C library can parse it; the file contents aren't terminated.
+// Numbers can't be this long so we just truncate anything longer.
+template <int N>
+void copyToken(const char* p, const char* end, char (&buf)[N]) {
+    const int n = (int)std::min<std::ptrdiff_t>(skipToken(p, end)-p, N-1);
+    std::memcpy(buf, p, n);
+    buf[n] = '\0';
+}
+
+// Parse a number at p, after any blanks, advancing p just past it. Like
+// operator>> this accepts a number at the start of a longer token, and fails
+// (leaving p alone) if there isn't one.
+bool parseReal(const char*& p, const char* end, Real& value) {
+    const char* q = skipBlanks(p, end);
+    // Don't let strtod() accept "inf", "nan" or hex where operator>> wouldn't.
+    if (q == end || !(std::isdigit((unsigned char)*q)
+                      || *q=='-' || *q=='+' || *q=='.'))
+        return false;
+    char buf[64]; copyToken(q, end, buf);
+    char* stop;
+    const double v = std::strtod(buf, &stop);
+    if (stop == buf) return false;
+    value = (Real)v;
+    p = q + (stop-buf);
+    return true;
+}
+
+bool parseInt(const char*& p, const char* end, int& value) {
+    const char* q = skipBlanks(p, end);
+    if (q == end || !(std::isdigit((unsigned char)*q) || *q=='-' || *q=='+'))
+        return false;
+    char buf[32]; copyToken(q, end, buf);
+    char* stop;
+    const long v = std::strtol(buf, &stop, 10);
+    if (stop == buf) return false;
+    value = (int)v;
+    p = q + (stop-buf);
+    return true;
+}
+
 }
 
 //------------------------------------------------------------------------------
 //                              LOAD OBJ FILE
 //------------------------------------------------------------------------------
+namespace {
+
+// What one chunk of an OBJ file contains. Face indices are kept as written
+// (1-based, or negative to count back from the latest vertex) because
+// resolving them requires knowing how many vertices came before the chunk.
+struct ObjChunk {
+    Array_<Vec3> vertices;
+    Array_<int>  faceIndices;
+    Array_<int>  faceEnd;        // one past each face's last index
+    Array_<int>  verticesBefore; // # of this chunk's vertices before each face
+    std::string  badVertexLine;  // the first malformed vertex line, if any
+};
+
+// Parse one line, with any continuations already joined.
+void parseObjLine(const char* begin, const char* end, ObjChunk& chunk) {
+    const char* p = skipBlanks(begin, end);
+    const char* command = p;
+    p = skipToken(p, end);
+    if (p-command != 1)
+        return;
+    if (*command == 'v') {
+        // A vertex
+        Vec3 v;
+        if (   !parseReal(p, end, v[0]) || !parseReal(p, end, v[1])
+            || !parseReal(p, end, v[2]))
+            chunk.badVertexLine.assign(begin, end);
+        else
+            chunk.vertices.push_back(v);
+    }
+    else if (*command == 'f') {
+        // A face. Each entry may be "v", "v/vt", "v//vn" or "v/vt/vn"; we
+        // only want the v and skip the rest up to the next space.
+        chunk.verticesBefore.push_back((int)chunk.vertices.size());
+        int index;
+        while (parseInt(p, end, index)) {
+            chunk.faceIndices.push_back(index);
+            p = std::find(p, end, ' ');
+            if (p < end) ++p;
+        }
+        chunk.faceEnd.push_back((int)chunk.faceIndices.size());
+    }
+}
+
+// Parse the lines in [begin,end). A line ending in a backslash continues on
+// the next line, with the backslash and newline replaced by a space.
+void parseObjChunk(const char* begin, const char* end, ObjChunk& chunk) {
+    std::string joined;
+    const char* p = begin;
+    while (p < end && chunk.badVertexLine.empty()) {
+        const char* e = findLineEnd(p, end);
+        if (e == p || e[-1] != '\\')
+            parseObjLine(p, e, chunk);
+        else {
+            joined.assign(p, e);
+            while (!joined.empty() && joined.back() == '\\') {
+                joined.back() = ' ';
+                p = e < end ? e+1 : end;
+                e = findLineEnd(p, end);
+                joined.append(p, e);
+            }
+            parseObjLine(joined.data(), joined.data()+joined.size(), chunk);
+        }
+        p = e < end ? e+1 : end;
+    }
+}
+
+// Parse an entire OBJ file and append its contents to a mesh.
+void loadObjContents(const char* begin, const char* end,
+                     PolygonalMeshImpl& mesh) {
+    const Array_<const char*> bounds = findLineChunks(begin, end, true);
+    const int numChunks = (int)bounds.size()-1;
+    Array_<ObjChunk> chunks(numChunks);
+    parseChunks(numChunks, [&](int c)
+    {   parseObjChunk(bounds[c], bounds[c+1], chunks[c]); });
+
+    int numVertices = 0, numFaces = 0, numFaceIndices = 0;
+    for (const ObjChunk& chunk : chunks) {
+        SimTK_ERRCHK1_ALWAYS(chunk.badVertexLine.empty(),
+            "PolygonalMesh::loadObjFile()",
+            "Found invalid vertex description: %s",
+            chunk.badVertexLine.c_str());
+        numVertices    += chunk.vertices.size();
+        numFaces       += chunk.faceEnd.size();
+        numFaceIndices += chunk.faceIndices.size();
+    }
+
+    mesh.vertices.reserve(mesh.vertices.size() + numVertices);
+    mesh.faceVertexStart.reserve(mesh.faceVertexStart.size() + numFaces);
+    mesh.faceVertexIndex.reserve(mesh.faceVertexIndex.size() + numFaceIndices);
+
+    // As always, indices are relative to the first vertex in this file.
+    int verticesBeforeChunk = 0;
+    for (const ObjChunk& chunk : chunks) {
+        mesh.vertices.insert(mesh.vertices.end(),
+                             chunk.vertices.begin(), chunk.vertices.end());
+        int faceStart = 0;
+        for (int f=0; f < (int)chunk.faceEnd.size(); ++f) {
+            const int verticesBefore =
+                verticesBeforeChunk + chunk.verticesBefore[f];
+            for (int i=faceStart; i < chunk.faceEnd[f]; ++i) {
+                const int index = chunk.faceIndices[i];
+                mesh.faceVertexIndex.push_back(index < 0 ? index+verticesBefore
+                                                         : index-1);
+            }
+            mesh.faceVertexStart.push_back((int)mesh.faceVertexIndex.size());
+            faceStart = chunk.faceEnd[f];
+        }
+        verticesBeforeChunk += chunk.vertices.size();
+    }
+}
+
+}
 
-// For the pathname signature just open and punt to the istream signature.
 void PolygonalMesh::loadObjFile(const String& pathname) {
-    std::ifstream ifs(pathname);
-    SimTK_ERRCHK1_ALWAYS(ifs.good(), "PolygonalMesh::loadObjFile()",
-        "Failed to open file '%s'", pathname.c_str());
-    loadObjFile(ifs);
-    ifs.close();
+    const MappedFile file(pathname, "PolygonalMesh::loadObjFile()");
+    initializeHandleIfEmpty();
+    loadObjContents(file.begin(), file.end(), updImpl());
 }
 
+// For the istream signature we read the whole stream in and parse it the
+// same way.
 void PolygonalMesh::loadObjFile(std::istream& file) {
     const char* methodName = "PolygonalMesh::loadObjFile()";
     SimTK_ERRCHK_ALWAYS(file.good(), methodName,
         "The supplied std::istream object was not in good condition"
         " on entrance -- did you check whether it opened successfully?");
 
-    std::string line;
-    Array_<int> indices;
-    int initialVertices = getNumVertices();
-    while (!file.eof()) {
-        SimTK_ERRCHK_ALWAYS(file.good(), methodName,
-            "An error occurred while reading the input file.");
-
-        std::getline(file, line);
-        while (line.size() > 0 && line[line.size()-1] == '\\') {
-            line[line.size()-1] = ' ';
-            std::string continuation;
-            std::getline(file, continuation);
-            line += continuation;
-        }
-        std::stringstream s(line);
-        std::string command;
-        s >> command;
-        if (command == "v") {
-            // A vertex
-            
-            Real x, y, z;
-            s >> x;
-            s >> y;
-            s >> z;
-            SimTK_ERRCHK1_ALWAYS(!s.fail(), methodName,
-                "Found invalid vertex description: %s", line.c_str());
-            addVertex(Vec3(x, y, z));
-        }
-        else if (command == "f") {
-            // A face
-            
-            indices.clear();
-            int index;
-            while (s >> index) {
-                s.ignore(line.size(), ' ');
-                if (index < 0)
-                    index += getNumVertices()-initialVertices;
-                else
-                    index--;
-                indices.push_back(index);
-            }
-            addFace(indices);
-        }
-    }
+    const std::string contents((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+    SimTK_ERRCHK_ALWAYS(!file.bad(), methodName,
+        "An error occurred while reading the input file.");
+    initializeHandleIfEmpty();
+    loadObjContents(contents.data(), contents.data()+contents.size(),
+                    updImpl());
 }
 
-
 //------------------------------------------------------------------------------
 //                              LOAD VTP FILE
 //------------------------------------------------------------------------------
@@ -299,87 +593,300 @@ The attributes of the DataArray elements are described as follows:
     format="ascii" -- The data are listed in ASCII directly inside the 
         DataArray element. Whitespace is used for separation.
 */
-void PolygonalMesh::loadVtpFile(const String& pathname) {
-  try
-  { const char* method = "PolygonalMesh::loadVtpFile()";
-    Xml::Document vtp(pathname);
-    // The file has been read in and parsed into memory by the Xml system.
-
-    SimTK_ERRCHK1_ALWAYS(vtp.getRootTag() == "VTKFile", method,
-        "Expected to see document tag <VTKFile> but saw <%s> instead.",
-        vtp.getRootTag().c_str());
-    // This is a VTKFile document.
-
-    Xml::Element root = vtp.getRootElement();
-    SimTK_ERRCHK1_ALWAYS(root.getRequiredAttributeValue("type") == "PolyData",
-        method, "Expected VTK file type='PolyData' but got type='%s'.",
-        root.getRequiredAttributeValue("type").c_str());
-    // This is a VTK PolyData document.
-
-    Xml::Element polydata = root.getRequiredElement("PolyData");
-    Xml::Element piece    = polydata.getRequiredElement("Piece");
-    Xml::Element points   = piece.getRequiredElement("Points");
-    const int numPoints = 
-        piece.getRequiredAttributeValueAs<int>("NumberOfPoints");
-    const int numPolys  = 
-        piece.getRequiredAttributeValueAs<int>("NumberOfPolys");
-
-    // Remember this because we'll have to use it to adjust the indices we use 
-    // when referencing the vertices we're about to read in. This number is
-    // the index that our first vertex will be assigned.
-    // EDIT: We actually don't use this variable. Leaving for reference.
-    // TODO const int firstVertex = getNumVertices();
-
-    // The lone DataArray element in the Points element contains the points'
-    // coordinates. Read it in as a Vector of Vec3s.
-    Xml::Element pointData = points.getRequiredElement("DataArray");
-    SimTK_ERRCHK1_ALWAYS(pointData.getRequiredAttributeValue("format")
-                         == "ascii", method, 
+namespace {
+
+const char* const VtpMethod = "PolygonalMesh::loadVtpFile()";
+
+// A forward-only scanner for just enough XML to read a VTK PolyData file.
+// It hands back one start tag, end tag, or run of text at a time; nothing is
+// copied except the (short) tag and attribute names and values.
+class XmlScanner {
+public:
+    enum Token {StartTag, EndTag, Text, EndOfFile};
+
+    XmlScanner(const char* begin, const char* end) : m_p(begin), m_end(end) {}
+
+    // Advance to the next start tag, end tag, or nonblank text, skipping
+    // the declaration, processing instructions, comments, and DOCTYPE.
+    Token next() {
+        while (true) {
+            const char* p = skipBlanks(m_p, m_end);
+            if (p == m_end) {m_p = p; return EndOfFile;}
+            if (*p != '<') {
+                m_text = p;
+                m_p = m_textEnd = std::find(p, m_end, '<');
+                return Text;
+            }
+            if (startsWith(p, "<?"))        m_p = skipPast(p, "?>");
+            else if (startsWith(p, "<!--")) m_p = skipPast(p, "-->");
+            else if (startsWith(p, "<![CDATA[")) {
+                m_text = p + 9;
+                m_p = skipPast(p, "]]>");
+                m_textEnd = m_p - 3;
+                return Text;
+            }
+            else if (startsWith(p, "<!"))   m_p = skipPast(p, ">");
+            else if (startsWith(p, "</")) {
+                m_name.assign(p+2, nameEnd(p+2));
+                m_p = skipPast(p, ">");
+                return EndTag;
+            }
+            else return scanStartTag(p+1);
+        }
+    }
+
+    // After StartTag or EndTag.
+    const std::string& getName() const {return m_name;}
+    // After StartTag; true if it was <name .../>, with no end tag to follow.
+    bool isEmptyElement() const {return m_isEmpty;}
+    // After StartTag; returns null if the attribute isn't present.
+    const std::string* findAttribute(const char* name) const {
+        for (const auto& a : m_attributes)
+            if (a.first == name) return &a.second;
+        return nullptr;
+    }
+    // After Text.
+    const char* getTextBegin() const {return m_text;}
+    const char* getTextEnd()   const {return m_textEnd;}
+
+private:
+    bool startsWith(const char* p, const char* prefix) const {
+        const std::size_t n = std::strlen(prefix);
+        return (std::size_t)(m_end-p) >= n && std::memcmp(p, prefix, n) == 0;
+    }
+
+    const char* skipPast(const char* p, const char* terminator) const {
+        const char* e = std::search(p, m_end, terminator,
+                                    terminator + std::strlen(terminator));
+        SimTK_ERRCHK1_ALWAYS(e != m_end, VtpMethod,
+            "Unterminated markup; expected '%s'.", terminator);
+        return e + std::strlen(terminator);
+    }
+
+    const char* nameEnd(const char* p) const {
+        while (p < m_end && !isBlank(*p) && *p!='>' && *p!='/' && *p!='=')
+            ++p;
+        return p;
+    }
+
+    Token scanStartTag(const char* p) {
+        const char* e = nameEnd(p);
+        m_name.assign(p, e);
+        m_attributes.clear();
+        while (true) {
+            p = skipBlanks(e, m_end);
+            SimTK_ERRCHK1_ALWAYS(p != m_end, VtpMethod,
+                "Unterminated start tag <%s>.", m_name.c_str());
+            if (*p == '>') {m_isEmpty = false; m_p = p+1; return StartTag;}
+            if (*p == '/') {m_isEmpty = true;  m_p = skipPast(p, ">");
+                            return StartTag;}
+            e = nameEnd(p);
+            std::string name(p, e);
+            p = skipBlanks(e, m_end);
+            SimTK_ERRCHK2_ALWAYS(p != m_end && *p == '=', VtpMethod,
+                "Expected a value for attribute '%s' of <%s>.",
+                name.c_str(), m_name.c_str());
+            p = skipBlanks(p+1, m_end);
+            SimTK_ERRCHK2_ALWAYS(p != m_end && (*p == '"' || *p == '\''),
+                VtpMethod, "Expected a quoted value for attribute '%s'"
+                " of <%s>.", name.c_str(), m_name.c_str());
+            e = std::find(p+1, m_end, *p);
+            SimTK_ERRCHK2_ALWAYS(e != m_end, VtpMethod,
+                "Unterminated value for attribute '%s' of <%s>.",
+                name.c_str(), m_name.c_str());
+            m_attributes.emplace_back(std::move(name), std::string(p+1, e));
+            ++e;
+        }
+    }
+
+    const char* m_p;
+    const char* const m_end;
+    const char* m_text = nullptr;
+    const char* m_textEnd = nullptr;
+    std::string m_name;
+    bool        m_isEmpty = false;
+    std::vector<std::pair<std::string,std::string> > m_attributes;
+};
+
+// Everything we need from the first Piece of a PolyData file.
+struct VtpPiece {
+    int          numPoints = -1, numPolys = -1;
+    bool         sawPoints = false, sawPointData = false, sawPolys = false;
+    bool         sawConnectivity = false, sawOffsets = false;
+    Array_<Real> coords;
+    Array_<int>  connectivity, offsets;
+};
+
+const std::string& getRequiredAttribute(const XmlScanner& xml,
+                                        const char* name) {
+    const std::string* value = xml.findAttribute(name);
+    SimTK_ERRCHK2_ALWAYS(value, VtpMethod,
+        "Element <%s> is missing required attribute '%s'.",
+        xml.getName().c_str(), name);
+    return *value;
+}
+
+int getRequiredIntAttribute(const XmlScanner& xml, const char* name) {
+    const std::string& value = getRequiredAttribute(xml, name);
+    const char* p = value.data();
+    const char* end = p + value.size();
+    int result;
+    SimTK_ERRCHK3_ALWAYS(parseInt(p, end, result) && skipBlanks(p, end)==end,
+        VtpMethod, "Attribute '%s' of <%s> should be an integer but was '%s'.",
+        name, xml.getName().c_str(), value.c_str());
+    return result;
+}
+
+void checkAsciiFormat(const XmlScanner& xml, const char* what) {
+    const std::string& format = getRequiredAttribute(xml, "format");
+    SimTK_ERRCHK2_ALWAYS(format == "ascii", VtpMethod,
         "Only format=\"ascii\" is supported for .vtp file DataArray elements,"
-        " got format=\"%s\" for Points DataArray.",
-        pointData.getRequiredAttributeValue("format").c_str());
+        " got format=\"%s\" for %s DataArray.", format.c_str(), what);
+}
 
-    Vector_<Vec3> coords = 
-        points.getRequiredElementValueAs< Vector_<Vec3> >("DataArray");
+// Append all the numbers in some element text to values.
+template <class T>
+void parseNumbers(const XmlScanner& xml, const char* what,
+                  bool (*parse)(const char*&, const char*, T&),
+                  Array_<T>& values) {
+    const char* p = xml.getTextBegin();
+    const char* end = xml.getTextEnd();
+    T value;
+    while (parse(p, end, value))
+        values.push_back(value);
+    SimTK_ERRCHK1_ALWAYS(skipBlanks(p, end) == end, VtpMethod,
+        "Found something other than numbers in the %s DataArray.", what);
+}
+
+// Read the first Piece of a VTK PolyData file. We keep track of where we are
+// with a stack of element names, and ignore everything we don't need.
+void scanVtpFile(const char* begin, const char* end, VtpPiece& piece) {
+    XmlScanner xml(begin, end);
+    std::vector<std::string> path;    // enclosing elements
+    Array_<Real>* reals = nullptr;    // where the current text goes
+    Array_<int>*  ints  = nullptr;
+    const char*   what  = nullptr;
+
+    for (XmlScanner::Token token = xml.next();
+         token != XmlScanner::EndOfFile; token = xml.next())
+    {
+        if (token == XmlScanner::Text) {
+            if (reals) parseNumbers(xml, what, parseReal, *reals);
+            else if (ints) parseNumbers(xml, what, parseInt, *ints);
+            continue;
+        }
 
-    SimTK_ERRCHK2_ALWAYS(coords.size() == numPoints, method,
+        if (token == XmlScanner::EndTag) {
+            SimTK_ERRCHK2_ALWAYS(!path.empty() && path.back()==xml.getName(),
+                VtpMethod, "Found end tag </%s> where </%s> was expected.",
+                xml.getName().c_str(),
+                path.empty() ? "" : path.back().c_str());
+            path.pop_back();
+            reals = nullptr; ints = nullptr;
+            // Only the first Piece is read.
+            if (path.size() == 2 && xml.getName() == "Piece")
+                return;
+            continue;
+        }
+
+        // A start tag.
+        const std::string& name = xml.getName();
+        const int depth = (int)path.size();
+        if (depth == 0) {
+            SimTK_ERRCHK1_ALWAYS(name == "VTKFile", VtpMethod,
+                "Expected to see document tag <VTKFile> but saw <%s> instead.",
+                name.c_str());
+            const std::string& type = getRequiredAttribute(xml, "type");
+            SimTK_ERRCHK1_ALWAYS(type == "PolyData", VtpMethod,
+                "Expected VTK file type='PolyData' but got type='%s'.",
+                type.c_str());
+        }
+        else if (depth == 2 && path[1] == "PolyData" && name == "Piece") {
+            piece.numPoints = getRequiredIntAttribute(xml, "NumberOfPoints");
+            piece.numPolys  = getRequiredIntAttribute(xml, "NumberOfPolys");
+        }
+        else if (depth == 3 && path[2] == "Piece") {
+            if (name == "Points") piece.sawPoints = true;
+            else if (name == "Polys") piece.sawPolys = true;
+        }
+        else if (depth == 4 && name == "DataArray") {
+            if (path[3] == "Points" && !piece.sawPointData) {
+                // Only the first DataArray holds the coordinates.
+                checkAsciiFormat(xml, "Points");
+                piece.sawPointData = true;
+                reals = &piece.coords; what = "Points";
+            }
+            else if (path[3] == "Polys") {
+                const std::string& arrayName = getRequiredAttribute(xml,"Name");
+                SimTK_ERRCHK2_ALWAYS(getRequiredAttribute(xml, "format")
+                                     == "ascii", VtpMethod,
+                    "Only format=\"ascii\" is supported for .vtp file"
+                    " DataArray elements, but format=\"%s\" for DataArray"
+                    " '%s'.", getRequiredAttribute(xml, "format").c_str(),
+                    arrayName.c_str());
+                if (arrayName == "connectivity") {
+                    piece.connectivity.clear();
+                    piece.sawConnectivity = true;
+                    ints = &piece.connectivity; what = "connectivity";
+                } else if (arrayName == "offsets") {
+                    piece.offsets.clear();
+                    piece.sawOffsets = true;
+                    ints = &piece.offsets; what = "offsets";
+                }
+            }
+        }
+        if (!xml.isEmptyElement())
+            path.push_back(name);
+        else {
+            reals = nullptr; ints = nullptr;
+        }
+    }
+
+    SimTK_ERRCHK_ALWAYS(path.empty(), VtpMethod,
+        "The file ended inside an element.");
+}
+
+}
+
+void PolygonalMesh::loadVtpFile(const String& pathname) {
+  try
+  { const char* method = VtpMethod;
+    const MappedFile file(pathname, method);
+    VtpPiece piece;
+    scanVtpFile(file.begin(), file.end(), piece);
+
+    SimTK_ERRCHK_ALWAYS(piece.numPoints >= 0, method,
+        "Expected to find a <Piece> element in <VTKFile><PolyData>.");
+    SimTK_ERRCHK_ALWAYS(piece.sawPoints, method,
+        "Expected to find a <Points> element in the <Piece>.");
+    const int numPoints = piece.numPoints;
+    const int numPolys  = piece.numPolys;
+
+    SimTK_ERRCHK1_ALWAYS(piece.coords.size() % 3 == 0, method,
+        "Expected 3 coordinates per point but got %d numbers.",
+        piece.coords.size());
+    SimTK_ERRCHK2_ALWAYS((int)piece.coords.size() == 3*numPoints, method,
         "Expected coordinates for %d points but got %d.",
-        numPoints, coords.size());
+        numPoints, piece.coords.size()/3);
 
     // Now that we have the point coordinates, use them to create the vertices
     // in our mesh.
     for (int i=0; i < numPoints; ++i)
-        addVertex(coords[i]);
+        addVertex(Vec3(piece.coords[3*i], piece.coords[3*i+1],
+                       piece.coords[3*i+2]));
 
     // Polys are given by a connectivity array which lists the points forming
     // each polygon in a long unstructured list, then an offsets array, one per
     // polygon, which gives the index+1 of the *last* connectivity entry for
     // each polygon.
-    Xml::Element polys = piece.getRequiredElement("Polys");
-
-    // Find the connectivity and offset DataArrays.
-    Xml::Element econnectivity, eoffsets;
-    for (Xml::element_iterator p = polys.element_begin("DataArray");
-         p != polys.element_end(); ++p) 
-    {       
-        const String& name = p->getRequiredAttributeValue("Name");
-        SimTK_ERRCHK2_ALWAYS(p->getRequiredAttributeValue("format")
-                             == "ascii", method, 
-            "Only format=\"ascii\" is supported for .vtp file DataArray"
-            " elements, but format=\"%s\" for DataArray '%s'.",
-            p->getRequiredAttributeValue("format").c_str(), name.c_str());
-
-        if (name == "connectivity") econnectivity = *p;
-        else if (name == "offsets") eoffsets = *p; 
-    }
-
-    SimTK_ERRCHK_ALWAYS(econnectivity.isValid() && eoffsets.isValid(), method, 
+    SimTK_ERRCHK_ALWAYS(piece.sawPolys, method,
+        "Expected to find a <Polys> element in the <Piece>.");
+    SimTK_ERRCHK_ALWAYS(piece.sawConnectivity && piece.sawOffsets, method,
         "Expected to find a DataArray with name='connectivity' and one with"
         " name='offsets' in the VTK PolyData file's <Polys> element but at"
         " least one of them was missing.");
 
-    // Read in the arrays.
-    Array_<int> offsets = eoffsets.getValueAs< Array_<int> >();
+    const Array_<int>& offsets = piece.offsets;
     // Size may have changed if file is bad.
     SimTK_ERRCHK2_ALWAYS(offsets.size() == numPolys, method,
         "The number of offsets (%d) should have matched the stated "
@@ -389,7 +896,7 @@ void PolygonalMesh::loadVtpFile(const String& pathname) {
     // end of the last polygon described in the connectivity array and hence
     // is the size of the connectivity array.
     const int expectedSize = numPolys ? offsets.back() : 0;
-    Array_<int> connectivity = econnectivity.getValueAs< Array_<int> >();
+    const Array_<int>& connectivity = piece.connectivity;
 
     SimTK_ERRCHK2_ALWAYS(connectivity.size()==expectedSize, method,
         "The connectivity array was the wrong size (%d). It should"
@@ -399,6 +906,10 @@ void PolygonalMesh::loadVtpFile(const String& pathname) {
     int startPoly = 0;
     for (int i=0; i < numPolys; ++i) {
         // Now read in the face in [startOffs,endOffs]
+        SimTK_ERRCHK3_ALWAYS(startPoly <= offsets[i]
+                             && offsets[i] <= expectedSize, method,
+            "Offset %d of polygon %d is out of order or past the end of the"
+            " connectivity array (%d).", offsets[i], i, expectedSize);
         addFace(connectivity(startPoly, offsets[i]-startPoly));
         startPoly = offsets[i]; // move to the next poly
     }
@@ -438,20 +949,193 @@ struct VertKey {
 typedef std::map<VertKey,int> VertMap;
 }
 
+//------------------------------------------------------------------------------
+//                              VERTEX WELDER
+//------------------------------------------------------------------------------
+// This finds an existing vertex that coincides with a new one to within a
+// tolerance in each coordinate, the same test VertKey uses, but by hashing
+// grid cells rather than searching a sorted map. Cells are twice the tolerance
+// wide so any match must be in one of at most 2x2x2 cells around the new
+// vertex. If several vertices match we take the earliest, so the result
+// doesn't depend on the hash.
+namespace {
+class VertexWelder {
+public:
+    explicit VertexWelder(Real tol) : m_tol(tol), m_cellSize(2*tol) {}
+
+    // If we're appending to an existing mesh its vertices are candidates too.
+    void addExistingVertices(const PolygonalMesh& mesh) {
+        for (int i=0; i < mesh.getNumVertices(); ++i)
+            insert(i, mesh.getVertexPosition(i));
+    }
+
+    // Look for a vertex close enough to this one and return its index if
+    // found, otherwise add to the mesh.
+    int getVertex(const Vec3& v, PolygonalMesh& mesh) {
+        long long lo[3], hi[3];
+        for (int i=0; i < 3; ++i) {
+            lo[i] = cellOf(v[i]-m_tol);
+            hi[i] = cellOf(v[i]+m_tol);
+        }
+        int found = -1;
+        for (long long x=lo[0]; x <= hi[0]; ++x)
+        for (long long y=lo[1]; y <= hi[1]; ++y)
+        for (long long z=lo[2]; z <= hi[2]; ++z) {
+            const CellMap::const_iterator p = m_cells.find(Cell{x,y,z});
+            if (p == m_cells.end()) continue;
+            for (int ix=p->second; ix >= 0; ix=m_next[ix])
+                if ((found < 0 || ix < found)
+                    && coincide(mesh.getVertexPosition(ix), v))
+                    found = ix;
+        }
+        if (found >= 0)
+            return found;
+        const int ix = mesh.addVertex(v);
+        insert(ix, v);
+        return ix;
+    }
+
+private:
+    struct Cell {
+        long long x, y, z;
+        bool operator==(const Cell& c) const
+        {   return x==c.x && y==c.y && z==c.z; }
+    };
+    struct CellHash {
+        std::size_t operator()(const Cell& c) const {
+            return std::hash<long long>()(
+                c.x*73856093LL ^ c.y*19349663LL ^ c.z*83492791LL);
+        }
+    };
+    // Each cell holds the most recent of its vertices; m_next chains them.
+    typedef std::unordered_map<Cell,int,CellHash> CellMap;
+
+    long long cellOf(Real x) const
+    {   return (long long)std::floor(x/m_cellSize); }
+
+    bool coincide(const Vec3& a, const Vec3& b) const {
+        return std::abs(a[0]-b[0]) <= m_tol && std::abs(a[1]-b[1]) <= m_tol
+            && std::abs(a[2]-b[2]) <= m_tol;
+    }
+
+    void insert(int ix, const Vec3& v) {
+        if (ix >= (int)m_next.size())
+            m_next.resize(ix+1, -1);
+        const Cell cell{cellOf(v[0]), cellOf(v[1]), cellOf(v[2])};
+        int& head = m_cells.insert(std::make_pair(cell, -1)).first->second;
+        m_next[ix] = head;
+        head = ix;
+    }
+
+    const Real  m_tol, m_cellSize;
+    CellMap     m_cells;
+    Array_<int> m_next;
+};
+}
+
 //------------------------------------------------------------------------------
 //                              LOAD STL FILE
 //------------------------------------------------------------------------------
 namespace {
 
+// One significant (not blank or comment) line of an ascii STL file.
+struct StlLine {
+    enum Kind {Solid, EndSolid, Color, Facet, Outer, Vertex, EndLoop, EndFacet,
+               Other};
+    int         lineNo;
+    Kind        kind;
+    bool        vertexOK;   // for Vertex lines
+    Vec3        vertex;
+    const char* keyword;    // as it appears in the file
+    int         keywordLength;
+};
+
+// The significant lines of one chunk of an ascii STL file. Line numbers are
+// counted from the start of the chunk until all the chunks are done.
+struct StlChunk {
+    Array_<StlLine> lines;
+    int             numLines = 0;
+};
+
+bool keywordIs(const char* p, const char* e, const char* lowerCase) {
+    for (; p < e && *lowerCase; ++p, ++lowerCase)
+        if (std::tolower((unsigned char)*p) != *lowerCase) return false;
+    return p == e && !*lowerCase;
+}
+
+// Can this be part of a number that operator>> reads the same way as
+// strtod()? We leave anything more exotic to operator>>.
+bool isPlainNumberChar(char c) {
+    return std::isdigit((unsigned char)c) || c=='-' || c=='+' || c=='.'
+        || c=='e' || c=='E';
+}
+
+// Tokenize the line [p,e). Returns false if it is blank or a comment.
+bool tokenizeStlLine(const char* p, const char* e, int lineNo, StlLine& line) {
+    p = skipBlanks(p, e);
+    if (p == e || *p=='#' || *p=='!' || *p=='$')
+        return false; // blank or comment
+    line.lineNo = lineNo;
+    line.keyword = p;
+    p = skipToken(p, e);
+    line.keywordLength = (int)(p - line.keyword);
+    const char* k = line.keyword;
+    line.kind =
+        keywordIs(k,p,"solid")                              ? StlLine::Solid
+      : keywordIs(k,p,"endsolid")                           ? StlLine::EndSolid
+      : keywordIs(k,p,"color")                              ? StlLine::Color
+      : keywordIs(k,p,"facet") || keywordIs(k,p,"facetnormal")
+                                                            ? StlLine::Facet
+      : keywordIs(k,p,"outer") || keywordIs(k,p,"outerloop")
+                                                            ? StlLine::Outer
+      : keywordIs(k,p,"vertex")                             ? StlLine::Vertex
+      : keywordIs(k,p,"endloop")                            ? StlLine::EndLoop
+      : keywordIs(k,p,"endfacet")                           ? StlLine::EndFacet
+      :                                                       StlLine::Other;
+    if (line.kind != StlLine::Vertex)
+        return true;
+
+    // The vertex must be exactly three numbers. The quick way handles plain
+    // numbers; otherwise read the rest of the (downshifted) line as a Vec3
+    // exactly as we always have.
+    const char* q = p;
+    line.vertexOK = parseReal(q, e, line.vertex[0])
+                 && parseReal(q, e, line.vertex[1])
+                 && parseReal(q, e, line.vertex[2])
+                 && skipBlanks(q, e) == e
+                 && std::all_of(p, e, [](char c)
+                                {return isBlank(c) || isPlainNumberChar(c);});
+    if (!line.vertexOK) {
+        String rest = String(std::string(p, e));
+        rest.toLower();
+        std::istringstream s(String::trimWhiteSpace(rest));
+        s >> line.vertex;
+        line.vertexOK = s.eof();
+    }
+    return true;
+}
+
+void tokenizeStlChunk(const char* begin, const char* end, StlChunk& chunk) {
+    for (const char* p = begin; p < end; ) {
+        const char* e = findLineEnd(p, end);
+        ++chunk.numLines;
+        StlLine line;
+        if (tokenizeStlLine(p, e, chunk.numLines, line))
+            chunk.lines.push_back(line);
+        p = e < end ? e+1 : end;
+    }
+}
+
 class STLFile {
 public:
-    STLFile(const String& pathname, const PolygonalMesh& mesh) 
+    STLFile(const String& pathname, const PolygonalMesh& mesh)
     :   m_pathname(pathname), m_pathcstr(pathname.c_str()),
-        m_vertexTol(NTraits<float>::getSignificant()),
-        m_lineNo(0), m_sigLineNo(0) 
-    {   preLoadVertMap(mesh); }
+        m_file(pathname, "PolygonalMesh::loadStlFile()"),
+        m_welder(NTraits<float>::getSignificant()),
+        m_numLines(0), m_lineNo(0), m_nextLine(0), m_keyword(StlLine::Other)
+    {   m_welder.addExistingVertices(mesh); }
 
-    // Examine file contents to determine whether this is an ascii-format 
+    // Examine file contents to determine whether this is an ascii-format
     // STL; otherwise it is binary.
     bool isStlAsciiFormat();
 
@@ -461,43 +1145,28 @@ public:
 private:
     bool getSignificantLine(bool eofOK);
 
-    // If we're appending to an existing mesh we'll need to preload the
-    // vertex map with the existing vertices.
-    void preLoadVertMap(const PolygonalMesh& mesh) {
-        for (int i=0; i < mesh.getNumVertices(); ++i) {
-            const Vec3& v = mesh.getVertexPosition(i);
-            m_vertMap.insert(std::make_pair(VertKey(v,m_vertexTol), i));
-        }
-    }
-
     // Look for a vertex close enough to this one and return its index if found,
     // otherwise add to the mesh.
-    int getVertex(const Vec3& v, PolygonalMesh& mesh) {
-        const VertKey key(v, m_vertexTol);
-        VertMap::const_iterator p = m_vertMap.find(key);
-        int ix;
-        if (p != m_vertMap.end()) 
-            ix = p->second;
-        else {
-            ix = mesh.addVertex(v);
-            m_vertMap.insert(std::make_pair(key,ix));
-        }
-        return ix;
+    int getVertex(const Vec3& v, PolygonalMesh& mesh)
+    {   return m_welder.getVertex(v, mesh); }
+
+    // The keyword of the current line, downshifted, for error messages.
+    String getKeyword() const {
+        const StlLine& line = m_lines[m_nextLine-1];
+        String keyword = String(std::string(line.keyword,line.keywordLength));
+        return keyword.toLower();
     }
 
-    // The ascii/binary determination reads some lines; counts must restart.
-    void resetLineCounts() {m_lineNo=m_sigLineNo=0;}
-
     const String&     m_pathname;
     const char* const m_pathcstr;
-    const Real        m_vertexTol;
-    VertMap           m_vertMap;
+    const MappedFile  m_file;
+    VertexWelder      m_welder;
 
-    std::ifstream     m_ifs;
+    Array_<StlLine>   m_lines;          // all the significant lines
+    int               m_numLines;       // total lines in the file
     int               m_lineNo;         // current line in file
-    int               m_sigLineNo;      // line # not counting blanks, comments
-    String            m_keyword;        // first non-blank token on line
-    std::stringstream m_restOfLine;     // full line except first token
+    int               m_nextLine;       // index into m_lines
+    StlLine::Kind     m_keyword;        // kind of the current line
 };
 
 }
@@ -543,103 +1212,114 @@ void PolygonalMesh::loadStlFile(const String& pathname) {
 // - Allow negative numbers in vertices (stl standard says only +ve).
 // - Allow more than three vertices per face.
 // - Allow 'outer loop'/'endloop' to be left out.
-// 
+//
 // If there are multiple solids in the STL file we'll just read the first one.
 
 // We have to decide if this is really an ascii format stl; it might be
 // binary. Unfortunately, some binary stl files also start with 'solid' so
 // that isn't enough. We will simply try to parse the file as ascii and then
-// if that leads to an inconsistency will try binary instead.
+// if that leads to an inconsistency will try binary instead. Only the first
+// few lines are looked at.
 bool STLFile::isStlAsciiFormat() {
-    m_ifs.open(m_pathname);
-    SimTK_ERRCHK1_ALWAYS(m_ifs.good(), "PolygonalMesh::loadStlFile()",
-        "Can't open file '%s'", m_pathcstr);
-
-    bool isAscii = false;
-    if (getSignificantLine(true) && m_keyword == "solid") {
-        // Still might be binary. Look for a "facet" or "endsolid" line.
-        while (getSignificantLine(true)) {
-            if (m_keyword=="color") continue; // ignore
-            isAscii = (   m_keyword=="facet" 
-                       || m_keyword=="facetnormal"
-                       || m_keyword=="endsolid");
+    Array_<StlLine> first;
+    int lineNo = 0;
+    for (const char* p = m_file.begin(); p < m_file.end() && first.size() < 2;) {
+        const char* e = findLineEnd(p, m_file.end());
+        StlLine line;
+        if (tokenizeStlLine(p, e, ++lineNo, line)
+            && !(first.size() == 1 && line.kind == StlLine::Color))
+            first.push_back(line);
+        if (first.size() == 1 && first[0].kind != StlLine::Solid)
             break;
-        }
+        p = e < m_file.end() ? e+1 : m_file.end();
     }
-
-    m_ifs.close();
-    resetLineCounts();
-    return isAscii;
+    // Still might be binary if it starts with "solid". Look for a "facet" or
+    // "endsolid" line.
+    return first.size() == 2 && first[0].kind == StlLine::Solid
+        && (   first[1].kind == StlLine::Facet
+            || first[1].kind == StlLine::EndSolid);
 }
 
 
 void STLFile::loadStlAsciiFile(PolygonalMesh& mesh) {
-    m_ifs.open(m_pathname);
-    SimTK_ERRCHK1_ALWAYS(m_ifs.good(), "PolygonalMesh::loadStlFile()",
-        "Can't open file '%s'", m_pathcstr);
+    // Tokenize all the lines, in parallel chunks for a big file.
+    const Array_<const char*> bounds =
+        findLineChunks(m_file.begin(), m_file.end(), false);
+    const int numChunks = (int)bounds.size()-1;
+    Array_<StlChunk> chunks(numChunks);
+    parseChunks(numChunks, [&](int c)
+    {   tokenizeStlChunk(bounds[c], bounds[c+1], chunks[c]); });
+
+    m_numLines = 0;
+    for (StlChunk& chunk : chunks) {
+        for (StlLine& line : chunk.lines) {
+            line.lineNo += m_numLines;
+            m_lines.push_back(line);
+        }
+        m_numLines += chunk.numLines;
+        chunk.lines.deallocate();
+    }
 
     Array_<int> vertices;
 
     // Don't allow EOF until we've seen two significant lines.
-    while (getSignificantLine(m_sigLineNo >= 2)) {
-        if (m_sigLineNo==1 && m_keyword == "solid") continue;
-        if (m_sigLineNo>1 && m_keyword == "endsolid")
+    while (getSignificantLine(m_nextLine >= 2)) {
+        if (m_nextLine==1 && m_keyword == StlLine::Solid) continue;
+        if (m_nextLine>1 && m_keyword == StlLine::EndSolid)
             break;
-        if (m_keyword == "color") continue;
+        if (m_keyword == StlLine::Color) continue;
 
-        if (m_keyword == "facet" || m_keyword == "facetnormal") {
+        if (m_keyword == StlLine::Facet) {
             // We're ignoring the normal on the facet line.
             getSignificantLine(false);
 
             bool outerLoopSeen=false;
-            if (m_keyword=="outer" || m_keyword=="outerloop") {
+            if (m_keyword == StlLine::Outer) {
                 outerLoopSeen = true;
                 getSignificantLine(false);
             }
 
             // Now process vertices.
             vertices.clear();
-            while (m_keyword == "vertex") {
-                Vec3 vertex;
-                m_restOfLine >> vertex;
-                SimTK_ERRCHK2_ALWAYS(m_restOfLine.eof(), 
+            while (m_keyword == StlLine::Vertex) {
+                const StlLine& line = m_lines[m_nextLine-1];
+                SimTK_ERRCHK2_ALWAYS(line.vertexOK,
                     "PolygonalMesh::loadStlFile()",
                     "Error at line %d in ASCII STL file '%s':\n"
                     "  badly formed vertex.", m_lineNo, m_pathcstr);
-                vertices.push_back(getVertex(vertex, mesh));
+                vertices.push_back(getVertex(line.vertex, mesh));
                 getSignificantLine(false);
             }
 
             // Next keyword is not "vertex".
-            SimTK_ERRCHK3_ALWAYS(vertices.size() >= 3, 
+            SimTK_ERRCHK3_ALWAYS(vertices.size() >= 3,
                 "PolygonalMesh::loadStlFile()",
                 "Error at line %d in ASCII STL file '%s':\n"
-                "  a facet had %d vertices; at least 3 required.", 
+                "  a facet had %d vertices; at least 3 required.",
                 m_lineNo, m_pathcstr, vertices.size());
 
             mesh.addFace(vertices);
 
             // Vertices must end with 'endloop' if started with 'outer loop'.
             if (outerLoopSeen) {
-                SimTK_ERRCHK3_ALWAYS(m_keyword=="endloop", 
+                SimTK_ERRCHK3_ALWAYS(m_keyword == StlLine::EndLoop,
                     "PolygonalMesh::loadStlFile()",
                     "Error at line %d in ASCII STL file '%s':\n"
                     "  expected 'endloop' but got '%s'.",
-                    m_lineNo, m_pathcstr, m_keyword.c_str());
+                    m_lineNo, m_pathcstr, getKeyword().c_str());
                 getSignificantLine(false);
             }
 
             // Now we expect 'endfacet'.
-            SimTK_ERRCHK3_ALWAYS(m_keyword=="endfacet", 
+            SimTK_ERRCHK3_ALWAYS(m_keyword == StlLine::EndFacet,
                 "PolygonalMesh::loadStlFile()",
                 "Error at line %d in ASCII STL file '%s':\n"
                 "  expected 'endfacet' but got '%s'.",
-                m_lineNo, m_pathcstr, m_keyword.c_str());
+                m_lineNo, m_pathcstr, getKeyword().c_str());
         }
     }
 
     // We don't care if there is extra stuff in the file.
-    m_ifs.close();
 }
 
 // This is the binary STL format:
@@ -656,86 +1336,181 @@ void STLFile::loadStlAsciiFile(PolygonalMesh& mesh) {
 // TODO: the STL binary format is always little-endian, like an Intel chip.
 // The code here won't work properly on a big endian machine!
 void STLFile::loadStlBinaryFile(PolygonalMesh& mesh) {
-    // This should never fail since the above succeeded, but we'll check.
-    m_ifs.open(m_pathname, std::ios_base::binary);
-    SimTK_ERRCHK1_ALWAYS(m_ifs.good(), "PolygonalMesh::loadStlFile()",
-        "Can't open file '%s'", m_pathcstr);
-
-    unsigned char header[80];
-    m_ifs.read((char*)header, 80);
-    SimTK_ERRCHK1_ALWAYS(m_ifs.good() && m_ifs.gcount()==80, 
+    const char* const end = m_file.end();
+    const char* p = m_file.begin();
+
+    SimTK_ERRCHK1_ALWAYS(m_file.size() >= 80,
         "PolygonalMesh::loadStlFile()", "Bad binary STL file '%s':\n"
         "  couldn't read header.", m_pathcstr);
+    p += 80;
 
-    unsigned nFaces;
-    m_ifs.read((char*)&nFaces, sizeof(unsigned));
-    SimTK_ERRCHK1_ALWAYS(m_ifs.good() && m_ifs.gcount()==sizeof(unsigned), 
+    std::uint32_t nFaces;
+    SimTK_ERRCHK1_ALWAYS(end-p >= (std::ptrdiff_t)sizeof(nFaces),
         "PolygonalMesh::loadStlFile()", "Bad binary STL file '%s':\n"
         "  couldn't read triangle count.", m_pathcstr);
+    std::memcpy(&nFaces, p, sizeof(nFaces));
+    p += sizeof(nFaces);
 
     Array_<int> vertices(3);
-    float vbuf[3]; unsigned short sbuf;
-    const unsigned vz = 3*sizeof(float);
+    float vbuf[3];
+    const std::ptrdiff_t vz = 3*sizeof(float);
     for (unsigned fx=0; fx < nFaces; ++fx) {
-        m_ifs.read((char*)vbuf, vz); // normal ignored
+        p += vz; // normal ignored
         for (int vx=0; vx < 3; ++vx) {
-            m_ifs.read((char*)vbuf, vz);
-            SimTK_ERRCHK3_ALWAYS(m_ifs.good() && m_ifs.gcount()==vz, 
+            SimTK_ERRCHK3_ALWAYS(end-p >= vz,
                 "PolygonalMesh::loadStlFile()", "Bad binary STL file '%s':\n"
                 "  couldn't read vertex %d for face %d.", m_pathcstr, vx, fx);
+            std::memcpy(vbuf, p, vz);
+            p += vz;
             const Vec3 vertex((Real)vbuf[0], (Real)vbuf[1], (Real)vbuf[2]);
             vertices[vx] = getVertex(vertex, mesh);
         }
         mesh.addFace(vertices);
-        // Now read and toss the "attribute byte count".
-        m_ifs.read((char*)&sbuf,sizeof(short));
-        SimTK_ERRCHK2_ALWAYS(m_ifs.good() && m_ifs.gcount()==sizeof(short), 
+        // Now skip the "attribute byte count".
+        SimTK_ERRCHK2_ALWAYS(end-p >= 2,
             "PolygonalMesh::loadStlFile()", "Bad binary STL file '%s':\n"
             "  couldn't read attribute for face %d.", m_pathcstr, fx);
+        p += 2;
     }
 
     // We don't care if there is extra stuff in the file.
-    m_ifs.close();
 }
 
-// Return the next line from the formatted input stream, ignoring blank
-// lines and comment lines, and downshifting the returned keyword. Sets
-// m_keyword and m_restOfLine and increments line counts. If eofOK==false,
-// issues an error message if we hit EOF, otherwise it will quitely return
-// false at EOF.
+// Advance to the next significant line (blank lines and comments were dropped
+// when the file was tokenized), setting m_keyword and m_lineNo. If
+// eofOK==false, issues an error message if we hit EOF, otherwise it will
+// quietly return false at EOF.
 bool STLFile::getSignificantLine(bool eofOK) {
-    std::string line;
-    std::getline(m_ifs, line);
-    while (m_ifs.good()) {
-        ++m_lineNo;
-        m_keyword = String::trimWhiteSpace(line); // using keyword as a temp
-        if (   m_keyword.empty() 
-            || m_keyword[0]=='#' || m_keyword[0]=='!' || m_keyword[0]=='$') 
-        {
-            std::getline(m_ifs, line);
-            continue; // blank or comment
-        }
-        // Found a significant line.
-        ++m_sigLineNo;
-        m_keyword.toLower();
-        m_restOfLine.clear();
-        m_restOfLine.str(m_keyword);
-        m_restOfLine >> m_keyword; // now it's the keyword at beginning of line
+    if (m_nextLine < (int)m_lines.size()) {
+        const StlLine& line = m_lines[m_nextLine++];
+        m_keyword = line.kind;
+        m_lineNo  = line.lineNo;
         return true;
     }
 
-    SimTK_ERRCHK2_ALWAYS(!(m_ifs.fail()||m_ifs.bad()),
-        "PolygonalMesh::loadStlFile()",
-        "Error at line %d in ASCII STL file '%s':\n"
-        "  error while reading file.", m_lineNo, m_pathcstr);
-
     // Must be EOF.
+    m_lineNo = m_numLines;
     SimTK_ERRCHK2_ALWAYS(eofOK, "PolygonalMesh::loadStlFile()",
         "Error at line %d in ASCII STL file '%s':\n"
         "  unexpected end of file.", m_lineNo, m_pathcstr);
     return false;
 }
 
+//------------------------------------------------------------------------------
+//                             BINARY MESH FILE
+//------------------------------------------------------------------------------
+// This is our own binary format, designed so that loading is a single read
+// followed by copying the arrays out:
+//   char[8]          - "SimTKmsh"
+//   uint32           - format version (1)
+//   uint32           - number of vertices nv
+//   uint32           - number of faces nf
+//   uint32           - total number of face vertices ni
+//   float64[3*nv]    - vertex positions
+//   int32[nf]        - number of vertices in each face
+//   int32[ni]        - vertex indices for all the faces, in order
+//
+// Like binary STL this is little-endian, and the same caveat applies.
+namespace {
+const char          MeshFileMagic[8] = {'S','i','m','T','K','m','s','h'};
+const std::uint32_t MeshFileVersion  = 1;
+const std::size_t   MeshFileHeaderBytes = 8 + 4*sizeof(std::uint32_t);
+}
+
+void PolygonalMesh::saveBinaryFile(const String& pathname) const {
+    const char* method = "PolygonalMesh::saveBinaryFile()";
+    std::ofstream out(pathname, std::ios_base::binary);
+    SimTK_ERRCHK1_ALWAYS(out.good(), method,
+        "Failed to open file '%s' for writing.", pathname.c_str());
+
+    const std::uint32_t nv = getNumVertices(), nf = getNumFaces(),
+        ni = isEmptyHandle() ? 0 : getImpl().faceVertexIndex.size();
+    out.write(MeshFileMagic, sizeof(MeshFileMagic));
+    for (std::uint32_t n : {MeshFileVersion, nv, nf, ni})
+        out.write((const char*)&n, sizeof(n));
+    for (std::uint32_t v=0; v < nv; ++v) {
+        const Vec3& position = getVertexPosition(v);
+        const double coords[3] = {position[0], position[1], position[2]};
+        out.write((const char*)coords, sizeof(coords));
+    }
+    for (std::uint32_t f=0; f < nf; ++f) {
+        const std::int32_t n = getNumVerticesForFace(f);
+        out.write((const char*)&n, sizeof(n));
+    }
+    for (std::uint32_t i=0; i < ni; ++i) {
+        const std::int32_t index = getImpl().faceVertexIndex[i];
+        out.write((const char*)&index, sizeof(index));
+    }
+    SimTK_ERRCHK1_ALWAYS(out.good(), method,
+        "An error occurred while writing file '%s'.", pathname.c_str());
+}
+
+void PolygonalMesh::loadBinaryFile(const String& pathname) {
+    const char* method = "PolygonalMesh::loadBinaryFile()";
+    std::ifstream in(pathname, std::ios_base::binary | std::ios_base::ate);
+    SimTK_ERRCHK1_ALWAYS(in.good(), method,
+        "Failed to open file '%s'", pathname.c_str());
+    const std::size_t size = (std::size_t)in.tellg();
+    in.seekg(0);
+    std::vector<char> contents(size);
+    in.read(contents.data(), size);
+    SimTK_ERRCHK1_ALWAYS(in.good(), method,
+        "An error occurred while reading file '%s'.", pathname.c_str());
+
+    const char* p = contents.data();
+    std::uint32_t version, nv, nf, ni;
+    SimTK_ERRCHK1_ALWAYS(size >= MeshFileHeaderBytes
+        && std::memcmp(p, MeshFileMagic, sizeof(MeshFileMagic)) == 0, method,
+        "File '%s' is not a Simbody binary mesh file.", pathname.c_str());
+    p += sizeof(MeshFileMagic);
+    for (std::uint32_t* n : {&version, &nv, &nf, &ni}) {
+        std::memcpy(n, p, sizeof(*n));
+        p += sizeof(*n);
+    }
+    SimTK_ERRCHK2_ALWAYS(version == MeshFileVersion, method,
+        "File '%s' has format version %u which we can't read.",
+        pathname.c_str(), (unsigned)version);
+    SimTK_ERRCHK1_ALWAYS(size == MeshFileHeaderBytes + 3*sizeof(double)*nv
+                                 + sizeof(std::int32_t)*(nf + ni), method,
+        "File '%s' is the wrong size for the mesh it says it contains.",
+        pathname.c_str());
+
+    initializeHandleIfEmpty();
+    PolygonalMeshImpl& impl = updImpl();
+    // Indices in the file are relative to its own first vertex.
+    const int firstVertex = impl.vertices.size();
+
+    impl.vertices.resize(firstVertex + nv);
+    for (std::uint32_t v=0; v < nv; ++v) {
+        double coords[3];
+        std::memcpy(coords, p, sizeof(coords));
+        p += sizeof(coords);
+        impl.vertices[firstVertex+v] = Vec3(coords[0], coords[1], coords[2]);
+    }
+
+    const char* counts = p;
+    const char* indices = p + sizeof(std::int32_t)*nf;
+    std::uint32_t i = 0;
+    impl.faceVertexStart.reserve(impl.faceVertexStart.size() + nf);
+    impl.faceVertexIndex.reserve(impl.faceVertexIndex.size() + ni);
+    for (std::uint32_t f=0; f < nf; ++f) {
+        std::int32_t n;
+        std::memcpy(&n, counts + sizeof(n)*f, sizeof(n));
+        SimTK_ERRCHK2_ALWAYS(n >= 0 && i + n <= ni, method,
+            "Face %u in file '%s' has a bad vertex count.",
+            (unsigned)f, pathname.c_str());
+        for (const std::uint32_t faceEnd = i + n; i < faceEnd; ++i) {
+            std::int32_t index;
+            std::memcpy(&index, indices + sizeof(index)*i, sizeof(index));
+            SimTK_ERRCHK2_ALWAYS(0 <= index && (std::uint32_t)index < nv,
+                method, "Face %u in file '%s' refers to a nonexistent vertex.",
+                (unsigned)f, pathname.c_str());
+            impl.faceVertexIndex.push_back(firstVertex + index);
+        }
+        impl.faceVertexStart.push_back(impl.faceVertexIndex.size());
+    }
+}
+
 //------------------------------------------------------------------------------
 //                            CREATE SPHERE MESH
 //------------------------------------------------------------------------------
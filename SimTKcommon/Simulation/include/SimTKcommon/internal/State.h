@@ -39,6 +39,8 @@ done in a separate internal class. **/
 #include <algorithm>
 #include <mutex>
 #include <array>
+#include <atomic>
+#include <memory>
 
 namespace SimTK {
 
@@ -129,6 +129,81 @@ private:
     CacheList               m_dependents;
 };
 
+//==============================================================================
+//                           SHARED STATE VALUE
+//==============================================================================
+/* This holds the value of a discrete variable or cache entry. Copying one
+does not clone the value; the copies share it instead, so that copying a State
+does not clone all of its discrete variable and cache entry values. Those can
+be large and are often never modified in one of the copies.
+
+Callers may keep references to a State's values, so a State must never find
+its values moved out from under it once it has handed out a reference. We
+ensure that with two rules:
+  - A State that was copied from another State is borrowing its values. It
+    makes private copies of all of them (cloning only those that are still
+    shared) before it first hands any of them out; see 
+    StateImpl::makeBorrowedValuesPrivate(). So a borrowing State never
+    hands out a reference to a shared value.
+  - Any other State owns its values and keeps them. If it asks for write
+    access to a value that some borrowing copy is still sharing, it leaves
+    the borrowers a clone to share and keeps the original. So its earlier
+    references, whether from getValue() or updValue(), stay valid.
+The value and its clone are swapped under a lock that borrowers also take
+while cloning, so States sharing a value may be used concurrently by
+different threads. A reference obtained from updValue() must not be used to
+write after the State has been copied, since the copy would see the change;
+ask for write access again instead. */
+class SharedStateValue {
+public:
+    SharedStateValue() = default;
+    explicit SharedStateValue(AbstractValue* v) 
+    :   m_box(v ? std::make_shared<Box>(v) : nullptr) {}
+
+    // Default copy constructor, copy assignment, and destructor share the
+    // value.
+
+    explicit operator bool() const {return (bool)m_box;}
+    bool isShared() const {return m_box.use_count() > 1;}
+
+    const AbstractValue& get() const {assert(m_box); return *m_box->value;}
+
+    // For use by the owning State.
+    AbstractValue& upd() {
+        assert(m_box);
+        if (isShared()) leaveCloneForBorrowers();
+        return *m_box->value;
+    }
+
+    // For use by a borrowing State.
+    void makePrivate() {
+        if (!isShared()) return;
+        const std::shared_ptr<Box> shared(m_box);
+        std::lock_guard<std::mutex> lock(shared->lock);
+        m_box = std::make_shared<Box>(shared->value->clone());
+    }
+
+    void swap(SharedStateValue& other) {m_box.swap(other.m_box);}
+    void reset() {m_box.reset();}
+
+private:
+    struct Box {
+        explicit Box(AbstractValue* v) : value(v) {}
+        std::mutex              lock;
+        ClonePtr<AbstractValue> value;
+    };
+
+    void leaveCloneForBorrowers() {
+        const std::shared_ptr<Box> shared(m_box);
+        std::lock_guard<std::mutex> lock(shared->lock);
+        AbstractValue* clone = shared->value->clone();
+        m_box = std::make_shared<Box>(shared->value.release());
+        shared->value.reset(clone);
+    }
+
+    std::shared_ptr<Box> m_box;
+};
+
 // These local classes
 //      DiscreteVarInfo
 //      CacheVarInfo
@@ -163,9 +238,8 @@ public:
 
     // Default copy constructor, copy assignment, destructor are shallow.
 
-    // Use this to make this entry contain a *copy* of the source value.
-    // If the destination already has a value, the new value must be
-    // assignment compatible.
+    // Use this to make this entry contain a *copy* of the source value. The
+    // value is shared until one of them writes on it; see SharedStateValue.
     DiscreteVarInfo& deepAssign(const DiscreteVarInfo& src) {
         *this = src; // copy assignment forgets dependents
         return *this;
@@ -179,10 +253,11 @@ public:
     const Stage& getAllocationStage()  const {return m_allocationStage;}
 
     // Exchange value pointers (should be from this dv's update cache entry).
-    void swapValue(Real updTime, ClonePtr<AbstractValue>& other) 
+    void swapValue(Real updTime, SharedStateValue& other) 
     {   m_value.swap(other); m_timeLastUpdated=updTime; }
 
-    const AbstractValue& getValue() const {assert(m_value); return *m_value;}
+    const AbstractValue& getValue() const {return m_value.get();}
+    void makeValuePrivate() {m_value.makePrivate();}
 
     // Whenever we hand out this variables value for write access we update
     // the value version, note the update time, and notify any dependents that
@@ -192,7 +267,7 @@ public:
        ++m_valueVersion;
        m_timeLastUpdated=updTime; 
        m_dependents.notePrerequisiteChange(stateImpl);
-       return *m_value; 
+       return m_value.upd(); 
     }
     ValueVersion getValueVersion() const {return m_valueVersion;}
     Real getTimeLastUpdated() const 
@@ -218,7 +293,7 @@ private:
     ResetOnCopy<ListOfDependents>   m_dependents;
 
     // These change at run time.
-    ClonePtr<AbstractValue>         m_value;
+    SharedStateValue                m_value;
     ValueVersion                    m_valueVersion{1};
     Real                            m_timeLastUpdated{NaN};
 
@@ -226,7 +301,7 @@ private:
     {    return (m_allocationStage==Stage::Topology 
                  || m_allocationStage==Stage::Model)
              && (m_invalidatedStage > m_allocationStage)
-             && (m_value != nullptr); }
+             && (bool)m_value; }
 };
 
 
@@ -331,7 +406,8 @@ public:
         m_dependents.notePrerequisiteChange(stateImpl);
     }
 
-    // Use this to make this entry contain a *copy* of the source value.
+    // Use this to make this entry contain a *copy* of the source value. The
+    // value is shared until one of them writes on it; see SharedStateValue.
     CacheEntryInfo& deepAssign(const CacheEntryInfo& src) {
         *this = src; // copy assignment forgets dependents
         return *this;
@@ -351,7 +427,8 @@ public:
     void swapValue(Real updTime, DiscreteVarInfo& dv) 
     {   dv.swapValue(updTime, m_value); }
 
-    const AbstractValue& getValue() const {assert(m_value); return *m_value;}
+    const AbstractValue& getValue() const {return m_value.get();}
+    void makeValuePrivate() {m_value.makePrivate();}
 
     // Merely handing out the cache entry's value with write access does not
     // trigger invalidation of dependents. (Maybe it should, but currently it
@@ -360,8 +437,7 @@ public:
     // explicit prerequisite change notification, or because the depends-on
     // stage got invalidated.
     AbstractValue& updValue(const StateImpl& stateImpl) {
-       assert(m_value); 
-       return *m_value; 
+       return m_value.upd(); 
     }
     ValueVersion getValueVersion() const {return m_valueVersion;}
 
@@ -424,7 +500,7 @@ private:
     // prerequisites so we are up to date with respect to them. We'll change
     // the initial value to false in registerWithPrerequisites() if there
     // are some.
-    ClonePtr<AbstractValue>     m_value;
+    SharedStateValue            m_value;
     ValueVersion                m_valueVersion{1};
     StageVersion                m_dependsOnVersionWhenLastComputed{0};
     bool                        m_isUpToDateWithPrerequisites{true};
@@ -445,7 +521,7 @@ private:
                 || m_allocationStage==Stage::Model
                 || m_allocationStage==Stage::Instance)
             && (m_computedByStage >= m_dependsOnStage)
-            && (m_value != nullptr)
+            && (bool)m_value
             && (m_dependsOnVersionWhenLastComputed >= 0)
             && (ListOfDependents::isCacheEntryKeyValid(m_myKey)); 
     }
@@ -1917,6 +1993,7 @@ public:
     // You can access a variable any time after it has been allocated.
     const AbstractValue& 
     getDiscreteVariable(const DiscreteVarKey& dk) const {
+        makeBorrowedValuesPrivateIfNeeded();
         const DiscreteVarInfo& dv = getDiscreteVarInfo(dk);   
         return dv.getValue();
     }
@@ -1967,6 +2044,7 @@ public:
     // Any explicit dependent cache entries are also invalidated.
     AbstractValue& 
     updDiscreteVariable(const DiscreteVarKey& dk) {
+        makeBorrowedValuesPrivateIfNeeded();
         DiscreteVarInfo& dv = updDiscreteVarInfo(dk);
     
         // Invalidate the "invalidates" stage. (All subsystems and the system
@@ -2009,6 +2087,7 @@ public:
     // it small so it gets inlined.
     const AbstractValue& 
     getCacheEntry(const CacheEntryKey& ck) const {
+        makeBorrowedValuesPrivateIfNeeded();
         const CacheEntryInfo& ce = getCacheEntryInfo(ck);
 
         if (!ce.isUpToDate(*this))
@@ -2020,6 +2099,7 @@ public:
     // allocated. This does not affect the stage.
     AbstractValue& 
     updCacheEntry(const CacheEntryKey& ck) const {
+        makeBorrowedValuesPrivateIfNeeded();
         return updCacheEntryInfo(ck).updValue(*this);
     }
 
@@ -2247,6 +2327,20 @@ private:
     // has its own mutex.
     mutable std::mutex stateLock;
 
+    // Set when this State is copied from another one, meaning that its 
+    // discrete variable and cache entry values may still be shared with that
+    // State (see SharedStateValue). Cleared once they have all been made
+    // private, which happens the first time any of them is accessed. The
+    // lock makes that safe when the first accesses are concurrent.
+    mutable std::atomic<bool> borrowingValues{false};
+    mutable std::mutex        borrowingValuesLock;
+
+    void makeBorrowedValuesPrivateIfNeeded() const {
+        if (borrowingValues.load(std::memory_order_acquire))
+            makeBorrowedValuesPrivate();
+    }
+    void makeBorrowedValuesPrivate() const;
+
 };
 
 //==============================================================================
@@ -392,7 +392,11 @@ void StateImpl::copyFrom(const StateImpl& src) {
     // it was up to date. We'll change some of these below if appropriate.
     invalidateCopiedStageVersions(src);
 
-    subsystems = src.subsystems;
+    {   // The source may be making its own borrowed values private on 
+        // another thread.
+        std::lock_guard<std::mutex> lock(src.borrowingValuesLock);
+        subsystems = src.subsystems;
+    }
     for (auto& subsys : subsystems)
         subsys.m_stateImpl = this;
 
@@ -426,6 +430,31 @@ void StateImpl::copyFrom(const StateImpl& src) {
     // DepedencyLists don't get copied. Any cache entries we copied must
     // re-register with their prerequisites to get these lists rebuilt.
     registerWithPrerequisitesAfterCopy();
+
+    // We're sharing the source's discrete variable and cache entry values.
+    borrowingValues.store(true, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+//                       MAKE BORROWED VALUES PRIVATE
+//------------------------------------------------------------------------------
+// This State was copied from another and may still be sharing discrete 
+// variable and cache entry values with it. Clone any that are still shared
+// before we hand out references to them. The values belong to this State but
+// this may be called from const methods, possibly from several threads.
+void StateImpl::makeBorrowedValuesPrivate() const {
+    std::lock_guard<std::mutex> lock(borrowingValuesLock);
+    if (!borrowingValues.load(std::memory_order_relaxed))
+        return; // another thread got here first
+
+    for (auto& subsys : subsystems) {
+        for (auto& dinfo : subsys.discreteInfo)
+            const_cast<DiscreteVarInfo&>(dinfo).makeValuePrivate();
+        for (auto& cinfo : subsys.cacheInfo)
+            cinfo.makeValuePrivate(); // mutable
+    }
+
+    borrowingValues.store(false, std::memory_order_release);
 }
 
 //------------------------------------------------------------------------------
@@ -766,6 +795,7 @@ void StateImpl::advanceSystemToStage(Stage stg) const {
 //                     AUTO UPDATE DISCRETE VARIABLES
 //------------------------------------------------------------------------------
 void StateImpl::autoUpdateDiscreteVariables() {
+    makeBorrowedValuesPrivateIfNeeded();
     // TODO: make this more efficient
     for (SubsystemIndex subx(0); subx < subsystems.size(); ++subx) {
         PerSubsystemInfo& ss = subsystems[subx];
@@ -36,8 +36,6 @@ class ParallelExecutorImpl;
 // We only want the template instantiation to occur once. This symbol is defined in the SimTK core
 // compilation unit that defines the ParallelExecutor class but should not be defined any other time.
 
-//TODO: Rewrite the threading class using C++11 std::thread
-
 #ifndef SimTK_SIMTKCOMMON_DEFINING_PARALLEL_EXECUTOR
     extern template class PIMPLHandle<ParallelExecutor, ParallelExecutorImpl>;
 #endif
@@ -57,6 +55,12 @@ class ParallelExecutorImpl;
  * on multiple threads, so you cannot make any assumptions about what order they will occur in
  * or which ones will happen at the same time.
  * 
+ * Indices are scheduled by work stealing: each thread takes a contiguous block of indices,
+ * and idle threads steal half of what another thread has not yet started. So it is fine for
+ * different indices to take very different amounts of time. The calling thread does its share
+ * of the work rather than waiting. A Task may itself call execute() on the same
+ * ParallelExecutor; the nested indices are shared among the same threads.
+ * 
  * The threads are created in the ParallelExecutor's constructor and remain active until it is deleted.
  * This means that creating a ParallelExecutor is a somewhat expensive operation, but it may then be
  * used repeatedly for executing various calculations.  By default, the number of threads is chosen
@@ -128,15 +132,18 @@ public:
      */
     virtual void execute(int index) = 0;
     /**
-     * This method is invoked once by each worker thread before the task is executed.  This can be used to
+     * This method is invoked once by each thread that takes part in executing the task, just before that thread
+     * executes its first index.  The calling thread is one of them, and a thread that finds no work left may not
+     * take part at all, so this may be called fewer times than there are threads.  This can be used to
      * initialize thread-local storage.
      */
     virtual void initialize() {
     }
     /**
-     * This method is invoked once by each worker thread after all invocations of the task on that thread are complete.
-     * This can be used to clean up thread-local storage, or to record per-thread results.  All calls to this method
-     * are synchronized, so it can safely write to global variables without danger of interference between worker threads.
+     * This method is invoked once by each thread for which initialize() was invoked, after all invocations of the
+     * task (on every thread) are complete, and before ParallelExecutor::execute() returns.  This can be used to
+     * clean up thread-local storage, or to record per-thread results.  All calls to this method are synchronized,
+     * so it can safely write to global variables without danger of interference between threads.
      */
     virtual void finish() {
     }
@@ -23,19 +23,34 @@
 
 #include "ParallelExecutorImpl.h"
 #include "SimTKcommon/internal/ParallelExecutor.h"
-#include <pthread.h>
 
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <exception>
 
 using namespace std;
 
 namespace SimTK {
 
-static void* threadBody(void* args);
+// The per-thread information for the ParallelExecutor this thread is
+// currently working for, if any. This is how we recognize a nested call to
+// execute() from inside one of our own Tasks.
+static thread_local ThreadInfo* currentThreadInfo = nullptr;
 
-ParallelExecutorImpl::ParallelExecutorImpl() : finished(false) {
+// How many times an idle thread checks for new work before going to sleep.
+// Waking a sleeping thread costs tens of microseconds, much more than a
+// typical Task; spinning for a little while lets back-to-back calls to
+// execute() (e.g. from successive realize() calls) avoid that.
+static const int SpinCount = 2000;
+
+// Each job is divided into at most about this many ranges per thread. More
+// ranges balance the load better when the cost per index varies; fewer 
+// reduce the scheduling overhead.
+static const int RangesPerThread = 8;
+
+ParallelExecutorImpl::ParallelExecutorImpl() 
+:   finished(false), workEpoch(0), sleepingThreadCount(0) {
 
     //By default, we use the total number of processors available of the
     //computer (including hyperthreads)
@@ -45,7 +60,8 @@ ParallelExecutorImpl::ParallelExecutorImpl() : finished(false) {
 
     ParallelExecutorImpl::init();
 }
-ParallelExecutorImpl::ParallelExecutorImpl(int numThreads) : finished(false) {
+ParallelExecutorImpl::ParallelExecutorImpl(int numThreads) 
+:   finished(false), workEpoch(0), sleepingThreadCount(0) {
 
     // Set the maximum number of threads that we can use
     SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "ParallelExecutorImpl",
@@ -57,36 +73,39 @@ ParallelExecutorImpl::ParallelExecutorImpl(int numThreads) : finished(false) {
 ParallelExecutorImpl::~ParallelExecutorImpl() {
     
     // Notify the threads that they should exit.
-    
-    pthread_mutex_lock(&runLock);
-    finished = true;
-    for (int i = 0; i < (int) threads.size(); ++i)
-        threadInfo[i]->running = true;
-    pthread_cond_broadcast(&runCondition);
-    pthread_mutex_unlock(&runLock);
+    {
+        lock_guard<mutex> lock(sleepLock);
+        finished = true;
+    }
+    sleepCondition.notify_all();
     
     // Wait until all the threads have finished.
     
-    for (int i = 0; i < (int) threads.size(); ++i)
-        pthread_join(threads[i], NULL);
+    for (auto& thread : threads)
+        thread.join();
     
-    // Clean up threading related objects.
-    
-    pthread_mutex_destroy(&runLock);
-    pthread_cond_destroy(&runCondition);
-    pthread_cond_destroy(&waitCondition);
+    for (ThreadInfo* info : threadInfo)
+        delete info;
 }
 ParallelExecutorImpl* ParallelExecutorImpl::clone() const {
     return new ParallelExecutorImpl(numMaxThreads);
 }
 void ParallelExecutorImpl::init()
 {
-  pthread_mutex_init(&runLock, NULL);
-  pthread_cond_init(&runCondition, NULL);
-  pthread_cond_init(&waitCondition, NULL);
+    // Slot 0 is for the non-worker thread that calls execute().
+    threadInfo.push_back(new ThreadInfo(0, this));
+}
+void ParallelExecutorImpl::launchThreads() {
+    // The calling thread does its share of the work, so we need one fewer 
+    // worker threads than the maximum number of threads.
+    for (int i = 1; i < numMaxThreads; ++i)
+        threadInfo.push_back(new ThreadInfo(i, this));
+    for (int i = 1; i < numMaxThreads; ++i)
+        threads.emplace_back(&ParallelExecutorImpl::runWorker, this, 
+                             std::ref(*threadInfo[i]));
 }
 void ParallelExecutorImpl::execute(ParallelExecutor::Task& task, int times) {
-  if (min(times, numMaxThreads) == 1) {
+  if (times <= 1 || numMaxThreads == 1) {
       //(1) NON-PARALLEL CASE:
       // Nothing is actually going to get done in parallel, so we might as well
       // just execute the task directly and save the threading overhead.
@@ -96,93 +115,162 @@ void ParallelExecutorImpl::execute(ParallelExecutor::Task& task, int times) {
       task.finish();
       return;
     }
-    
+
     //(2) PARALLEL CASE:
-    // We launch the maximum number of threads and save them for later use
-    if(threads.size() < (size_t)numMaxThreads)
-    {
-      threads.resize(numMaxThreads);
-      for (int i = 0; i < numMaxThreads; ++i) {
-          threadInfo.push_back(new ThreadInfo(i, this));
-          pthread_create(&threads[i], NULL, threadBody, threadInfo[i]);
-      }
+    ParallelJob job(task, times, 
+                    std::max(1, times/(RangesPerThread*numMaxThreads)));
+
+    if (currentThreadInfo && currentThreadInfo->executor == this) {
+        // Nested call from one of our own Tasks; this thread already has a
+        // slot.
+        pushRange(*currentThreadInfo, ParallelRange(&job, 0, times));
+        helpUntilDone(*currentThreadInfo, job);
+        return;
     }
 
-  // Initialize fields to execute the new task.
-  pthread_mutex_lock(&runLock);
-  currentTask = &task;
-  currentTaskCount = times;
-  waitingThreadCount = 0;
-  for (int i = 0; i < (int) threadInfo.size(); ++i)
-      threadInfo[i]->running = true;
-
-  // Wake up the worker threads and wait until they finish.
-  pthread_cond_broadcast(&runCondition);
-  do {
-      pthread_cond_wait(&waitCondition, &runLock);
-  } while (waitingThreadCount < (int) threads.size());
-  pthread_mutex_unlock(&runLock);
+    // Call from an outside thread (possibly a worker of some other 
+    // executor). It takes slot 0 and works alongside our threads.
+    lock_guard<mutex> lock(externalCallerLock);
+    // We launch the maximum number of threads and save them for later use
+    if (threads.empty())
+        launchThreads();
+
+    ThreadInfo* const prevInfo = currentThreadInfo;
+    const bool prevIsWorker = isWorker.get();
+    currentThreadInfo = threadInfo[0];
+    isWorker.upd() = true;
+
+    pushRange(*threadInfo[0], ParallelRange(&job, 0, times));
+    helpUntilDone(*threadInfo[0], job);
+
+    isWorker.upd() = prevIsWorker;
+    currentThreadInfo = prevInfo;
+}
+void ParallelExecutorImpl::runWorker(ThreadInfo& info) {
+    isWorker.upd() = true;
+    currentThreadInfo = &info;
+    while (!finished) {
+        const unsigned lastSeen = workEpoch.load();
+        ParallelRange range;
+        if (findRange(info, range))
+            executeRange(info, range);
+        else if (!finishCompletedJobs(info))
+            waitForWork(lastSeen);
+    }
+}
+void ParallelExecutorImpl::helpUntilDone(ThreadInfo& info, ParallelJob& job) {
+    while (!job.isDone()) {
+        const unsigned lastSeen = workEpoch.load();
+        ParallelRange range;
+        if (findRange(info, range))
+            executeRange(info, range);
+        else if (!finishCompletedJobs(info) && !job.isDone())
+            waitForWork(lastSeen);
+    }
 }
-void ParallelExecutorImpl::incrementWaitingThreads() {
-    pthread_mutex_lock(&runLock);
-    getCurrentTask().finish();
-    waitingThreadCount++;
-    if (waitingThreadCount == (int)threads.size()) {
-        pthread_cond_signal(&waitCondition);
+bool ParallelExecutorImpl::findRange(ThreadInfo& info, ParallelRange& range) {
+    {   lock_guard<mutex> lock(info.dequeLock);
+        if (!info.ranges.empty()) {
+            range = info.ranges.back();
+            info.ranges.pop_back();
+            return true;
+        }
+    }
+    const int n = (int)threadInfo.size();
+    for (int k = 1; k < n; ++k) {
+        ThreadInfo& victim = *threadInfo[(info.index + k) % n];
+        lock_guard<mutex> lock(victim.dequeLock);
+        if (!victim.ranges.empty()) {
+            range = victim.ranges.front();
+            victim.ranges.pop_front();
+            return true;
+        }
     }
-    pthread_mutex_unlock(&runLock);
+    return false;
 }
+void ParallelExecutorImpl::executeRange(ThreadInfo& info, ParallelRange range) {
+    ParallelJob& job = *range.job;
 
-ThreadLocal<bool> ParallelExecutorImpl::isWorker(false);
+    // Leave the second half of the range for someone else to steal; keep
+    // doing that until what we have left is small.
+    while (range.end - range.begin > job.grainSize) {
+        const int mid = range.begin + (range.end - range.begin)/2;
+        pushRange(info, ParallelRange(&job, mid, range.end));
+        range.end = mid;
+    }
+
+    if (std::find(info.unfinishedJobs.begin(), info.unfinishedJobs.end(), 
+                  &job) == info.unfinishedJobs.end()) {
+        ++job.pendingFinishes;
+        info.unfinishedJobs.push_back(&job);
+        job.task.initialize();
+    }
+
+    try {
+        for (int index = range.begin; index < range.end; ++index)
+            job.task.execute(index);
+    }
+    catch (const std::exception& ex) {
+        std::cerr <<"The parallel task threw an unhandled exception:"<< std::endl;
+        std::cerr <<ex.what()<< std::endl;
+    }
+    catch (...) {
+        std::cerr <<"The parallel task threw an error."<< std::endl;
+    }
 
-/**
- * This function contains the code executed by the worker threads.
- */
-
-void* threadBody(void* args) {
-    ParallelExecutorImpl::isWorker.upd() = true;
-    ThreadInfo& info = *reinterpret_cast<ThreadInfo*>(args);
-    ParallelExecutorImpl& executor = *info.executor;
-    int threadCount = executor.getThreadCount();
-    while (!executor.isFinished()) {
-        
-        // Wait for a Task to come in.
-        
-        pthread_mutex_lock(executor.getLock());
-        while (!info.running) {
-            pthread_cond_wait(executor.getCondition(), executor.getLock());
+    const int count = range.end - range.begin;
+    if (job.remaining.fetch_sub(count) == count)
+        notifyWork(); // participants can call finish() now
+}
+bool ParallelExecutorImpl::finishCompletedJobs(ThreadInfo& info) {
+    bool anyFinished = false;
+    for (unsigned i = 0; i < info.unfinishedJobs.size(); ) {
+        ParallelJob& job = *info.unfinishedJobs[i];
+        if (job.remaining.load() != 0) {
+            ++i;
+            continue;
         }
-        pthread_mutex_unlock(executor.getLock());
-        if (!executor.isFinished()) {
-            
-            // Execute the task for all the indices belonging to this thread.
-            
-            int count = executor.getCurrentTaskCount();
-            ParallelExecutor::Task& task = executor.getCurrentTask();
-            task.initialize();
-            int index = info.index;
-                        
-            try {
-                while (index < count) {
-                    task.execute(index);
-                    index += threadCount;
-                }
-            }
-            catch (const std::exception& ex) {
-                std::cerr <<"The parallel task threw an unhandled exception:"<< std::endl;
-                std::cerr <<ex.what()<< std::endl;
-            }
-            catch (...) {
-                std::cerr <<"The parallel task threw an error."<< std::endl;
-            }
-            info.running = false;
-            executor.incrementWaitingThreads();
+        info.unfinishedJobs.eraseFast(info.unfinishedJobs.begin() + i);
+        {   lock_guard<mutex> lock(job.finishLock);
+            job.task.finish();
         }
+        --job.pendingFinishes; // job may be gone after this
+        notifyWork();
+        anyFinished = true;
+    }
+    return anyFinished;
+}
+void ParallelExecutorImpl::pushRange(ThreadInfo& info, 
+                                     const ParallelRange& range) {
+    {   lock_guard<mutex> lock(info.dequeLock);
+        info.ranges.push_back(range);
+    }
+    notifyWork();
+}
+void ParallelExecutorImpl::waitForWork(unsigned lastSeen) {
+    for (int i = 0; i < SpinCount; ++i) {
+        if (workEpoch.load() != lastSeen || finished)
+            return;
+        std::this_thread::yield();
+    }
+    unique_lock<mutex> lock(sleepLock);
+    ++sleepingThreadCount;
+    while (workEpoch.load() == lastSeen && !finished)
+        sleepCondition.wait(lock);
+    --sleepingThreadCount;
+}
+void ParallelExecutorImpl::notifyWork() {
+    ++workEpoch;
+    // This and the order of operations in waitForWork() guarantee that 
+    // either the sleeper sees the new epoch or we see the sleeper.
+    if (sleepingThreadCount.load() > 0) {
+        lock_guard<mutex> lock(sleepLock);
+        sleepCondition.notify_all();
     }
-    delete &info;
-    return 0;
 }
 
+ThreadLocal<bool> ParallelExecutorImpl::isWorker(false);
+
 ParallelExecutor::ParallelExecutor() : HandleBase(new ParallelExecutorImpl()) {
 }
 
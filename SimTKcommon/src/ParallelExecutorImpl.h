@@ -28,31 +28,81 @@
 #include "SimTKcommon/internal/ThreadLocal.h"
 #include "SimTKcommon/internal/Array.h"
 
-#include <pthread.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <thread>
-#include <iostream>
 
 namespace SimTK {
 
 class ParallelExecutorImpl;
 
 /**
- * This class stores per-thread information used while executing a task.
+ * This is one call to ParallelExecutor::execute(). It lives on the stack of
+ * the calling thread, which doesn't return until every index has been
+ * executed and every participating thread has called finish().
  */
- 
-//TODO: Rewrite the threading class using C++11 std::thread
+class ParallelJob {
+public:
+    ParallelJob(ParallelExecutor::Task& task, int times, int grainSize) 
+    :   task(task), grainSize(grainSize), remaining(times), 
+        pendingFinishes(0) {}
+    bool isDone() const {
+        return remaining.load() == 0 && pendingFinishes.load() == 0;
+    }
+    ParallelExecutor::Task& task;
+    const int grainSize;
+    // Number of indices not yet executed.
+    std::atomic<int> remaining;
+    // Number of threads that called initialize() but not yet finish().
+    std::atomic<int> pendingFinishes;
+    // Serializes calls to finish().
+    std::mutex finishLock;
+};
 
+/**
+ * A contiguous range [begin,end) of indices of a ParallelJob. 
+ */
+struct ParallelRange {
+    ParallelRange() : job(nullptr), begin(0), end(0) {}
+    ParallelRange(ParallelJob* job, int begin, int end) 
+    :   job(job), begin(begin), end(end) {}
+    ParallelJob* job;
+    int begin, end;
+};
+
+/**
+ * This class stores per-thread information: the thread's deque of ranges
+ * waiting to be executed, and the jobs it has initialized but not yet 
+ * finished. Slot 0 belongs to whichever non-worker thread is currently
+ * inside execute(); the other slots belong to the worker threads. 
+ */
 class ThreadInfo {
 public:
-    ThreadInfo(int index, ParallelExecutorImpl* executor) : index(index), executor(executor), running(false) {
-    }
+    ThreadInfo(int index, ParallelExecutorImpl* executor) 
+    :   index(index), executor(executor) {}
     const int index;
     ParallelExecutorImpl* const executor;
-    bool running;
+
+    // The owner pushes and pops at the back; thieves steal from the front,
+    // where the biggest ranges are.
+    std::mutex              dequeLock;
+    std::deque<ParallelRange> ranges;
+
+    // Only the owning thread touches this.
+    Array_<ParallelJob*>    unfinishedJobs;
 };
 
 /**
- * This is the internal implementation class for ParallelExecutor.
+ * This is the internal implementation class for ParallelExecutor. It is a
+ * work-stealing scheduler: execute() puts the whole index range on the 
+ * calling thread's deque, and idle threads steal from the front of other
+ * threads' deques. Ranges are split in half lazily when they are taken, so
+ * they are only divided as finely as needed to keep every thread busy. A 
+ * thread that calls execute() from inside a Task helps with whatever work is
+ * available until its own job is done, so nested parallelism neither 
+ * deadlocks nor oversubscribes the processors.
  */
 
 class ParallelExecutorImpl : public PIMPLImplementation<ParallelExecutor, ParallelExecutorImpl> {
@@ -62,40 +112,42 @@ public:
     ~ParallelExecutorImpl();
     ParallelExecutorImpl* clone() const;
     void execute(ParallelExecutor::Task& task, int times);
-    int getThreadCount() {
-        return threads.size();
-    }
-    ParallelExecutor::Task& getCurrentTask() {
-        return *currentTask;
-    }
-    int getCurrentTaskCount() {
-        return currentTaskCount;
-    }
-    bool isFinished() {
-        return finished;
-    }
-    pthread_mutex_t* getLock() {
-        return &runLock;
-    }
-    pthread_cond_t* getCondition() {
-        return &runCondition;
-    }
     int getMaxThreads() const{
       return numMaxThreads;
     }
-    void incrementWaitingThreads();
+    void runWorker(ThreadInfo& info);
     static ThreadLocal<bool> isWorker;
 private:
     void init();
-    bool finished;
-    pthread_mutex_t runLock;
-    pthread_cond_t runCondition, waitCondition;
-    Array_<pthread_t> threads;
-    Array_<ThreadInfo*> threadInfo;
-    ParallelExecutor::Task* currentTask;
-    int currentTaskCount;
-    int waitingThreadCount;
+    void launchThreads();
+    // Execute ranges and finish jobs until the given one is done.
+    void helpUntilDone(ThreadInfo& info, ParallelJob& job);
+    // Pop a range from our own deque or steal one. Returns false if there
+    // was no work anywhere.
+    bool findRange(ThreadInfo& info, ParallelRange& range);
+    void executeRange(ThreadInfo& info, ParallelRange range);
+    // Call finish() for any of our jobs whose indices are all done. Returns
+    // true if there were any.
+    bool finishCompletedJobs(ThreadInfo& info);
+    void pushRange(ThreadInfo& info, const ParallelRange& range);
+    // Spin briefly, then sleep until workEpoch changes from lastSeen.
+    void waitForWork(unsigned lastSeen);
+    void notifyWork();
+
+    std::atomic<bool> finished;
     int numMaxThreads;
+    Array_<std::thread> threads;
+    Array_<ThreadInfo*> threadInfo; // one more than threads; see ThreadInfo
+
+    // Only one non-worker thread at a time can use slot 0.
+    std::mutex externalCallerLock;
+
+    // Incremented whenever there may be new work, or a job's indices are
+    // all done. Sleeping threads wait for it to change.
+    std::atomic<unsigned> workEpoch;
+    std::atomic<int> sleepingThreadCount;
+    std::mutex sleepLock;
+    std::condition_variable sleepCondition;
 };
 
 } // namespace SimTK
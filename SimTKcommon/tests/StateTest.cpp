@@ -30,6 +30,8 @@
 #include <iostream>
 #include <exception>
 #include <cmath>
+#include <thread>
+#include <vector>
 using std::cout;
 using std::endl;
 using std::string;
@@ -411,6 +413,109 @@ void testMisc() {
     //cout << "after clear(), State s=" << s;
 }
 
+// A value type that counts how many times it has been copied.
+struct CountCopies {
+    CountCopies() = default;
+    explicit CountCopies(int v) : value(v) {}
+    CountCopies(const CountCopies& src) : value(src.value) {++numCopies;}
+    CountCopies& operator=(const CountCopies& src) 
+    {   value = src.value; ++numCopies; return *this; }
+    int value = 0;
+    static std::atomic<int> numCopies;
+};
+std::atomic<int> CountCopies::numCopies(0);
+
+static const CountCopies& getDV(const State& s, DiscreteVariableIndex dx) {
+    return Value<CountCopies>::downcast
+        (s.getDiscreteVariable(SubsystemIndex(0), dx)).get();
+}
+static CountCopies& updDV(State& s, DiscreteVariableIndex dx) {
+    return Value<CountCopies>::updDowncast
+        (s.updDiscreteVariable(SubsystemIndex(0), dx)).upd();
+}
+static const CountCopies& getCE(const State& s, CacheEntryIndex cx) {
+    return Value<CountCopies>::downcast
+        (s.getCacheEntry(SubsystemIndex(0), cx)).get();
+}
+static CountCopies& updCE(const State& s, CacheEntryIndex cx) {
+    return Value<CountCopies>::updDowncast
+        (s.updCacheEntry(SubsystemIndex(0), cx)).upd();
+}
+
+// Copying a State shares its discrete variable and cache entry values rather
+// than cloning them. References to a State's values must stay valid, and keep
+// showing that State's values, no matter what the copies do.
+void testSharedValues() {
+    const SubsystemIndex Sub0(0);
+    State s;
+    s.setNumSubsystems(1);
+    // Copies are realized only through Instance stage, so use that for the
+    // discrete variable and cache entry to keep the cache value valid.
+    const DiscreteVariableIndex dx = s.allocateDiscreteVariable(Sub0,
+        Stage::Instance, new Value<CountCopies>(CountCopies(1)));
+    const CacheEntryIndex cx = s.allocateCacheEntry(Sub0,
+        Stage::Instance, Stage::Infinity, new Value<CountCopies>());
+    advanceStage(s, Stage::Topology);
+    advanceStage(s, Stage::Model);
+    advanceStage(s, Stage::Instance);
+    updCE(s, cx).value = 2;
+    s.markCacheValueRealized(Sub0, cx);
+
+    CountCopies::numCopies = 0;
+    State copy1(s), copy2;
+    copy2 = s;
+    {   State unused1(s), unused2(copy1); }
+    SimTK_TEST(CountCopies::numCopies == 0);
+    SimTK_TEST(copy1.getSystemStage() == Stage::Instance);
+    SimTK_TEST(copy2.isCacheValueRealized(Sub0, cx));
+
+    // The source keeps its values; a reference held across a write sees the
+    // write. The copies are left sharing a clone.
+    const CountCopies& sCE = getCE(s, cx);
+    updCE(s, cx).value = 5;
+    SimTK_TEST(CountCopies::numCopies == 1);
+    SimTK_TEST(sCE.value == 5);
+    SimTK_TEST(&getCE(s, cx) == &sCE);
+
+    // A copy makes its values private the first time it touches any of them,
+    // cloning the ones still shared: both here.
+    SimTK_TEST(getCE(copy1, cx).value == 2);
+    SimTK_TEST(CountCopies::numCopies == 3);
+    const CountCopies& c1DV = getDV(copy1, dx);
+    updDV(copy1, dx).value = 10;
+    SimTK_TEST(CountCopies::numCopies == 3);
+    SimTK_TEST(c1DV.value == 10);
+    SimTK_TEST(copy1.getSystemStage() == Stage::Model);
+    SimTK_TEST(getDV(s, dx).value == 1);
+
+    // copy2 shares only the discrete variable with s now.
+    const CountCopies& c2DV = getDV(copy2, dx);
+    SimTK_TEST(CountCopies::numCopies == 4);
+    SimTK_TEST(c2DV.value == 1 && getCE(copy2, cx).value == 2);
+
+    // Nothing is shared any more so writing doesn't copy.
+    updDV(s, dx).value = 3;
+    updCE(copy2, cx).value = 6;
+    SimTK_TEST(CountCopies::numCopies == 4);
+    SimTK_TEST(c2DV.value == 1 && sCE.value == 5 && getDV(s, dx).value == 3);
+
+    // Copies of one State can be made, read, and written by several threads
+    // at once.
+    std::vector<std::thread> threads;
+    std::atomic<int> numWrong(0);
+    for (int t=0; t < 4; ++t)
+        threads.emplace_back([&, t]() {
+            for (int i=0; i < 200; ++i) {
+                State mine(copy2);
+                if (getCE(mine, cx).value != 6) ++numWrong;
+                updCE(mine, cx).value = t;
+                if (getCE(mine, cx).value != t) ++numWrong;
+            }
+        });
+    for (auto& thread : threads) thread.join();
+    SimTK_TEST(numWrong == 0);
+}
+
 // Helper functions for testConsistent().
 // Allocate some part of the state, and alter the stage accordingly.
 // For Q, U, Z.
@@ -537,5 +642,6 @@ int main() {
         SimTK_SUBTEST(testCacheValidity);
         SimTK_SUBTEST(testMisc);
         SimTK_SUBTEST(testConsistent);
+        SimTK_SUBTEST(testSharedValues);
     SimTK_END_TEST();
 }
@@ -98,11 +98,73 @@ void testResizeThreads() {
         SimTK_TEST(executor.getMaxThreads() == x);
     }
 }
+// Each index runs a nested parallel loop on the same executor.
+class NestedTask : public ParallelExecutor::Task {
+public:
+    NestedTask(ParallelExecutor& executor, Array_<Array_<int> >& flags)
+    :   executor(executor), flags(flags) {}
+    void execute(int index) override {
+        int count = 0;
+        SetFlagTask inner(flags[index], count);
+        executor.execute(inner, flags[index].size());
+        ASSERT(count == (int)flags[index].size());
+    }
+private:
+    ParallelExecutor& executor;
+    Array_<Array_<int> >& flags;
+};
+
+void testNestedExecution() {
+    isParallel = (ParallelExecutor::getNumProcessors() > 1);
+    ParallelExecutor executor;
+    Array_<Array_<int> > flags(20);
+    for (int i = 0; i < 20; ++i)
+        flags[i].resize(5*i+1, 0);
+    NestedTask task(executor, flags);
+    executor.execute(task, flags.size());
+    for (int i = 0; i < 20; ++i)
+        for (int j = 0; j < (int)flags[i].size(); ++j)
+            ASSERT(flags[i][j] == 1);
+    ASSERT(!ParallelExecutor::isWorkerThread());
+}
+
+// A few indices are much more expensive than the rest; all of them must
+// still be executed exactly once.
+class UnevenTask : public ParallelExecutor::Task {
+public:
+    explicit UnevenTask(Array_<double>& results) : results(results) {}
+    void execute(int index) override {
+        const int n = (index % 17 == 0) ? 200000 : 10;
+        double sum = 0;
+        for (int i = 0; i < n; ++i)
+            sum += std::sqrt(double(i));
+        results[index] += sum;
+    }
+private:
+    Array_<double>& results;
+};
+
+void testUnevenExecution() {
+    ParallelExecutor executor(4);
+    Array_<double> results(1000, 0.);
+    UnevenTask task(results);
+    executor.execute(task, results.size());
+    for (int i = 0; i < (int)results.size(); ++i)
+        ASSERT(results[i] > 0);
+    // Once more, to reuse the sleeping threads.
+    Array_<double> expected = results;
+    executor.execute(task, results.size());
+    for (int i = 0; i < (int)results.size(); ++i)
+        ASSERT(results[i] == 2*expected[i]);
+}
+
 int main() {
     SimTK_START_TEST("TestParallelExecutor");
         SimTK_SUBTEST(testParallelExecution);
         SimTK_SUBTEST(testSingleThreadedExecution);
         SimTK_SUBTEST(testResizeThreads);
+        SimTK_SUBTEST(testNestedExecution);
+        SimTK_SUBTEST(testUnevenExecution);
     SimTK_END_TEST();
     return 0;
 }
@@ -23,9 +23,14 @@
 
 #include "SimTKcommon.h"
 
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 
 #define ASSERT(cond) {SimTK_ASSERT_ALWAYS(cond, "Assertion failed");}
+#define ASSERT_THROW(stmt) \
+    {bool threw = false; try {stmt;} catch (const std::exception&) {threw = true;} \
+     ASSERT(threw);}
 
 using std::cout;
 using std::endl;
@@ -109,10 +114,205 @@ void testLoadObjFile() {
     ASSERT(mesh.getFaceVertex(3, 3) == 1);
 }
 
+static void writeFile(const string& name, const string& contents) {
+    ofstream out(name, ios_base::binary);
+    out << contents;
+}
+
+static void assertSameMesh(const PolygonalMesh& a, const PolygonalMesh& b) {
+    ASSERT(a.getNumVertices() == b.getNumVertices());
+    ASSERT(a.getNumFaces() == b.getNumFaces());
+    for (int i = 0; i < a.getNumVertices(); i++)
+        ASSERT(a.getVertexPosition(i) == b.getVertexPosition(i));
+    for (int i = 0; i < a.getNumFaces(); i++) {
+        ASSERT(a.getNumVerticesForFace(i) == b.getNumVerticesForFace(i));
+        for (int j = 0; j < a.getNumVerticesForFace(i); j++)
+            ASSERT(a.getFaceVertex(i, j) == b.getFaceVertex(i, j));
+    }
+}
+
+// A file big enough to be parsed in several chunks, with continued lines and
+// relative indices that straddle the chunk boundaries.
+void testLoadLargeObjFile() {
+    const int n = 100000;
+    string file;
+    for (int i = 0; i < n; i++) {
+        file += "v " + to_string(i) + ".25 " + to_string(-i) + " \\\n"
+              + to_string(2*i) + "e-1\n";
+        if (i >= 2)
+            file += i%2 ? "f -3/1 -2//4 \\\n-1\n" 
+                        : "f " + to_string(i-1) + " " + to_string(i) 
+                          + " " + to_string(i+1) + "\n";
+    }
+    ASSERT(file.size() > 4*1024*1024);
+    writeFile("TestPolygonalMesh.obj", file);
+
+    PolygonalMesh mesh;
+    mesh.loadFile("TestPolygonalMesh.obj");
+    ASSERT(mesh.getNumVertices() == n);
+    ASSERT(mesh.getNumFaces() == n-2);
+    for (int i = 0; i < n; i++)
+        ASSERT(mesh.getVertexPosition(i) == Vec3(i+0.25, -i, 0.2*i));
+    for (int f = 0; f < n-2; f++) {
+        ASSERT(mesh.getNumVerticesForFace(f) == 3);
+        for (int j = 0; j < 3; j++)
+            ASSERT(mesh.getFaceVertex(f, j) == f+j);
+    }
+
+    // The stream version gives the same mesh.
+    PolygonalMesh streamMesh;
+    stringstream stream(file);
+    streamMesh.loadObjFile(stream);
+    assertSameMesh(mesh, streamMesh);
+
+    writeFile("TestPolygonalMesh.obj", file + "v 1 2 x\n");
+    PolygonalMesh bad;
+    ASSERT_THROW(bad.loadObjFile("TestPolygonalMesh.obj"));
+    remove("TestPolygonalMesh.obj");
+}
+
+// The same tetrahedron as ascii and binary STL. Vertices repeated in the file
+// must be merged.
+void testLoadStlFile() {
+    const Vec3 v[4] = {Vec3(0), Vec3(1,0,0), Vec3(0,1,0), Vec3(0,0,1)};
+    const int faces[4][3] = {{0,2,1}, {0,1,3}, {0,3,2}, {1,2,3}};
+
+    string ascii = "solid tet\n";
+    string binary(80, ' ');
+    const unsigned numFaces = 4;
+    binary.append((const char*)&numFaces, 4);
+    for (int f = 0; f < 4; f++) {
+        ascii += "# a comment\n  FACET normal 0 0 0\n    outer loop\n";
+        float buf[12] = {0};
+        for (int j = 0; j < 3; j++) {
+            const Vec3& p = v[faces[f][j]];
+            // Perturb within the merging tolerance.
+            ascii += "      vertex " + to_string(p[0]+1e-9) + " " 
+                   + to_string(p[1]) + " " + to_string(p[2]) + "\n";
+            for (int k = 0; k < 3; k++)
+                buf[3+3*j+k] = (float)p[k];
+        }
+        ascii += "    endloop\n  endfacet\n";
+        binary.append((const char*)buf, sizeof(buf));
+        binary.append(2, '\0');
+    }
+    ascii += "endsolid tet\n";
+    writeFile("TestPolygonalMesh.stl", ascii);
+    writeFile("TestPolygonalMeshBinary.stl", binary);
+
+    PolygonalMesh asciiMesh, binaryMesh;
+    asciiMesh.loadFile("TestPolygonalMesh.stl");
+    binaryMesh.loadFile("TestPolygonalMeshBinary.stl");
+    const PolygonalMesh* meshes[] = {&asciiMesh, &binaryMesh};
+    for (const PolygonalMesh* mesh : meshes) {
+        ASSERT(mesh->getNumVertices() == 4);
+        ASSERT(mesh->getNumFaces() == 4);
+        for (int f = 0; f < 4; f++)
+            for (int j = 0; j < 3; j++)
+                ASSERT(mesh->getFaceVertex(f, j) == faces[f][j]);
+    }
+    assertSameMesh(asciiMesh, binaryMesh);
+
+    // Loading again appends, reusing the existing vertices.
+    binaryMesh.loadStlFile("TestPolygonalMeshBinary.stl");
+    ASSERT(binaryMesh.getNumVertices() == 4);
+    ASSERT(binaryMesh.getNumFaces() == 8);
+
+    writeFile("TestPolygonalMesh.stl", 
+              "solid bad\nfacet normal 0 0 0\nvertex 0 0 0\nendfacet\n");
+    PolygonalMesh bad;
+    ASSERT_THROW(bad.loadFile("TestPolygonalMesh.stl"));
+    remove("TestPolygonalMesh.stl");
+    remove("TestPolygonalMeshBinary.stl");
+}
+
+void testLoadVtpFile() {
+    const string vtp =
+        "<?xml version=\"1.0\"?>\n"
+        "<!-- A square and a triangle -->\n"
+        "<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n"
+        "  <PolyData>\n"
+        "    <Piece NumberOfPoints=\"5\" NumberOfVerts=\"0\" NumberOfLines=\"0\"\n"
+        "           NumberOfStrips=\"0\" NumberOfPolys=\"2\">\n"
+        "      <PointData Normals=\"N\">\n"
+        "        <DataArray type=\"Float32\" Name=\"N\" NumberOfComponents=\"3\""
+        " format=\"ascii\">0 0 1 0 0 1 0 0 1 0 0 1 0 0 1</DataArray>\n"
+        "      </PointData>\n"
+        "      <Points>\n"
+        "        <DataArray type=\"Float32\" NumberOfComponents=\"3\""
+        " format='ascii'>\n"
+        "          0 0 0  1 0 0  1 1 0\n"
+        "          0 1 0  0.5 2 -1.5e-1\n"
+        "        </DataArray>\n"
+        "      </Points>\n"
+        "      <Polys>\n"
+        "        <DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">"
+        "4 7</DataArray>\n"
+        "        <DataArray type=\"Int32\" Name=\"connectivity\""
+        " format=\"ascii\">0 1 2 3 3 2 4</DataArray>\n"
+        "      </Polys>\n"
+        "    </Piece>\n"
+        "    <Piece NumberOfPoints=\"1\" NumberOfPolys=\"0\"/>\n"
+        "  </PolyData>\n"
+        "</VTKFile>\n";
+    writeFile("TestPolygonalMesh.vtp", vtp);
+    PolygonalMesh mesh;
+    mesh.loadFile("TestPolygonalMesh.vtp");
+    ASSERT(mesh.getNumVertices() == 5);
+    ASSERT(mesh.getVertexPosition(4) == Vec3(0.5, 2, -0.15));
+    ASSERT(mesh.getNumFaces() == 2);
+    ASSERT(mesh.getNumVerticesForFace(0) == 4);
+    ASSERT(mesh.getNumVerticesForFace(1) == 3);
+    ASSERT(mesh.getFaceVertex(1, 2) == 4);
+
+    string binary = vtp;
+    binary.replace(binary.find("format='ascii'"), 14, "format='binary'");
+    writeFile("TestPolygonalMesh.vtp", binary);
+    PolygonalMesh bad;
+    ASSERT_THROW(bad.loadFile("TestPolygonalMesh.vtp"));
+    remove("TestPolygonalMesh.vtp");
+}
+
+void testBinaryFile() {
+    const PolygonalMesh sphere = PolygonalMesh::createSphereMesh(1.5, 3);
+    PolygonalMesh polys;
+    polys.addVertex(Vec3(1, 2, 3));
+    polys.addVertex(Vec3(4, 5, 6));
+    polys.addVertex(Vec3(7, 8, 9));
+    polys.addVertex(Vec3(1, 0, 1));
+    polys.addFace(Array_<int>({0, 1, 2, 3}));
+    polys.addFace(Array_<int>({3, 2, 1}));
+
+    const PolygonalMesh* originals[] = {&sphere, &polys};
+    for (const PolygonalMesh* original : originals) {
+        original->saveBinaryFile("TestPolygonalMesh.simtkmesh");
+        PolygonalMesh mesh;
+        mesh.loadFile("TestPolygonalMesh.simtkmesh");
+        assertSameMesh(mesh, *original);
+    }
+
+    // Appending offsets the new faces' vertex indices.
+    PolygonalMesh mesh;
+    mesh.copyAssign(sphere);
+    mesh.loadBinaryFile("TestPolygonalMesh.simtkmesh");
+    ASSERT(mesh.getNumFaces() == sphere.getNumFaces()+2);
+    ASSERT(mesh.getFaceVertex(sphere.getNumFaces()+1, 0) 
+           == sphere.getNumVertices()+3);
+
+    writeFile("TestPolygonalMesh.simtkmesh", "SimTKmsh but truncated");
+    PolygonalMesh bad;
+    ASSERT_THROW(bad.loadBinaryFile("TestPolygonalMesh.simtkmesh"));
+    remove("TestPolygonalMesh.simtkmesh");
+}
+
 int main() {
     try {
         testCreateMesh();
         testLoadObjFile();
+        testLoadLargeObjFile();
+        testLoadStlFile();
+        testLoadVtpFile();
+        testBinaryFile();
     } catch(const std::exception& e) {
         cout << "exception: " << e.what() << endl;
         return 1;
@@ -0,0 +1,99 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+
+// Measure the scheduling overhead of ParallelExecutor. We time execute() on
+// trivial tasks of various sizes and report the cost per call and per index,
+// and compare a task whose index costs vary wildly against doing the same 
+// work serially. Usage: ParallelExecutorBenchmark [numThreads]
+
+#include "SimTKcommon.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace SimTK;
+
+class EmptyTask : public ParallelExecutor::Task {
+public:
+    void execute(int) override {}
+};
+
+// Every 16th index is 1000 times as expensive as the others, similar to a
+// force subsystem with a few contact or muscle forces among many springs.
+class UnevenTask : public ParallelExecutor::Task {
+public:
+    explicit UnevenTask(Array_<double>& out) : out(out) {}
+    void execute(int index) override {
+        const int n = (index % 16 == 0) ? 20000 : 20;
+        double sum = 0;
+        for (int i = 0; i < n; ++i)
+            sum += std::sin(double(i+index));
+        out[index] = sum;
+    }
+private:
+    Array_<double>& out;
+};
+
+static double now() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char** argv) {
+    const int numThreads = argc > 1 ? std::atoi(argv[1]) 
+                                    : ParallelExecutor::getNumProcessors();
+    ParallelExecutor executor(std::max(numThreads, 1));
+    printf("ParallelExecutor with %d threads on %d processors\n", 
+           executor.getMaxThreads(), ParallelExecutor::getNumProcessors());
+
+    EmptyTask empty;
+    executor.execute(empty, 64); // launch the threads
+    printf("%10s %12s %14s\n", "indices", "us/call", "ns/index");
+    for (int times : {2, 8, 64, 1024, 16384}) {
+        const int reps = std::max(100, 200000/times);
+        const double t0 = now();
+        for (int r = 0; r < reps; ++r)
+            executor.execute(empty, times);
+        const double t = (now()-t0)/reps;
+        printf("%10d %12.2f %14.1f\n", times, 1e6*t, 1e9*t/times);
+    }
+
+    Array_<double> out(4096);
+    UnevenTask uneven(out);
+    const int reps = 20;
+    double t0 = now();
+    for (int r = 0; r < reps; ++r)
+        for (int i = 0; i < (int)out.size(); ++i)
+            uneven.execute(i);
+    const double serial = (now()-t0)/reps;
+    t0 = now();
+    for (int r = 0; r < reps; ++r)
+        executor.execute(uneven, out.size());
+    const double parallel = (now()-t0)/reps;
+    printf("uneven task: serial %.3f ms, parallel %.3f ms, speedup %.2f\n",
+           1e3*serial, 1e3*parallel, serial/parallel);
+    return 0;
+}
@@ -147,6 +147,21 @@ may return any of them.
 specified point. **/
 Vec3 findNearestPoint(const Vec3& position, bool& inside, UnitVec3& normal) const;
 
+/** Find the nearest surface point for each of a batch of points, with the
+same results as calling findNearestPoint() on each in turn. Surfaces that can
+reuse work between neighboring points (TriangleMesh) do so, so a batch should
+be ordered to keep nearby points together. All the arrays must have the same
+length; the output arrays are overwritten. Different threads may query the
+same ContactGeometry concurrently as long as they write to different arrays.
+@param[in]  positions   The points in question.
+@param[out] points      The nearest surface point to each of \a positions.
+@param[out] inside      Whether each point is inside this object.
+@param[out] normals     The surface normal at each of \a points. **/
+void findNearestPoints(const ArrayViewConst_<Vec3>& positions,
+                       ArrayView_<Vec3>&            points,
+                       ArrayView_<bool>&            inside,
+                       ArrayView_<UnitVec3>&        normals) const;
+
 /** Given a query point Q, find the nearest point P on the surface of this 
 object, looking only down the local gradient. Thus we cannot guarantee that P
 is the globally nearest point; if you need that use the findNearestPoint()
@@ -1266,6 +1281,31 @@ may return any of them.
 @return The point on the surface of the object which is closest to the 
 specified point. **/
 Vec3 findNearestPoint(const Vec3& position, bool& inside, int& face, Vec2& uv) const;
+/** Batched form of findNearestPoint(const Vec3&, bool&, UnitVec3&); see
+ContactGeometry::findNearestPoints(). **/
+void findNearestPoints(const ArrayViewConst_<Vec3>& positions,
+                       ArrayView_<Vec3>&            points,
+                       ArrayView_<bool>&            inside,
+                       ArrayView_<UnitVec3>&        normals) const;
+/** Batched form of findNearestPoint(const Vec3&, bool&, int&, Vec2&) that can
+start from a guess at each point's nearest face. A guess that is close to the
+answer lets most of the OBBTree be skipped; the answer from a previous time
+step is usually a very good guess. Guesses only affect the speed, never the
+result. The previous point of the batch also serves as a guess, so nearby
+points should be kept together. All the arrays must have the same length.
+@param[in]     positions   The points in question.
+@param[in,out] faces       On entry, a guess at the nearest face to each point,
+                           or -1 for no guess. On exit, the face containing
+                           each returned point.
+@param[out]    points      The nearest surface point to each of \a positions.
+@param[out]    inside      Whether each point is inside this object.
+@param[out]    uvs         The barycentric coordinates of each returned point
+                           within its face. **/
+void findNearestPoints(const ArrayViewConst_<Vec3>& positions,
+                       ArrayView_<int>&             faces,
+                       ArrayView_<Vec3>&            points,
+                       ArrayView_<bool>&            inside,
+                       ArrayView_<Vec2>&            uvs) const;
 
 /** Given a point and a face of this object, find the point of the face that is
 nearest the given point. If multiple points on the face are equally close to 
@@ -114,6 +114,19 @@ Vec3 ContactGeometry::findNearestPoint(const Vec3& position, bool& inside, UnitV
     return getImpl().findNearestPoint(position, inside, normal);
 }
 
+void ContactGeometry::findNearestPoints(const ArrayViewConst_<Vec3>& positions,
+                                        ArrayView_<Vec3>&            points,
+                                        ArrayView_<bool>&            inside,
+                                        ArrayView_<UnitVec3>&        normals) const {
+    const unsigned n = positions.size();
+    SimTK_APIARGCHECK4_ALWAYS(points.size() == n && inside.size() == n
+        && normals.size() == n, "ContactGeometry", "findNearestPoints",
+        "Got %u positions but %u points, %u inside flags and %u normals.",
+        n, (unsigned)points.size(), (unsigned)inside.size(), 
+        (unsigned)normals.size());
+    getImpl().findNearestPoints(positions, points, inside, normals);
+}
+
 Vec3 ContactGeometry::projectDownhillToNearestPoint(const Vec3& Q) const {
     return getImpl().projectDownhillToNearestPoint(Q);
 }
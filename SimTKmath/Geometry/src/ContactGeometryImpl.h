@@ -78,6 +78,20 @@ public:
     virtual Vec3 findNearestPoint(const Vec3& position, bool& inside, 
                                   UnitVec3& normal) const = 0;
 
+    // Concrete classes that can share work between the points of a batch
+    // override this; the arrays have already been checked to be the same
+    // length.
+    virtual void findNearestPoints(const ArrayViewConst_<Vec3>& positions,
+                                   ArrayView_<Vec3>&            points,
+                                   ArrayView_<bool>&            inside,
+                                   ArrayView_<UnitVec3>&        normals) const
+    {   for (unsigned i = 0; i < positions.size(); ++i) {
+            bool isInside;
+            points[i] = findNearestPoint(positions[i], isInside, normals[i]);
+            inside[i] = isInside;
+        }
+    }
+
     virtual bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
                                Real& distance, UnitVec3& normal) const = 0;
 
@@ -979,17 +993,40 @@ private:
 //==============================================================================
 //                            OBB TREE NODE IMPL
 //==============================================================================
+// One node of a TriangleMesh's OBBTree. All the nodes of a tree live in a 
+// single array in depth-first order, so a node's first child immediately 
+// follows it and only the distance to the second child needs to be stored. 
+// The triangles of all the leaves are likewise stored contiguously by the
+// tree; a leaf's "triangles" member is a non-owning view of its own slice,
+// which the owning OBBTreeImpl sets up (copying a node does not copy it).
 class OBBTreeNodeImpl {
 public:
-    OBBTreeNodeImpl() : child1(NULL), child2(NULL), numTriangles(0) {
+    OBBTreeNodeImpl() : secondChildOffset(0), firstTriangle(0), 
+                        numTriangles(0) {}
+    OBBTreeNodeImpl(const OBBTreeNodeImpl& src) 
+    :   bounds(src.bounds), secondChildOffset(src.secondChildOffset),
+        firstTriangle(src.firstTriangle), numTriangles(src.numTriangles) {}
+    OBBTreeNodeImpl& operator=(const OBBTreeNodeImpl& src) {
+        bounds            = src.bounds;
+        secondChildOffset = src.secondChildOffset;
+        firstTriangle     = src.firstTriangle;
+        numTriangles      = src.numTriangles;
+        triangles.deallocate();
+        return *this;
     }
-    OBBTreeNodeImpl(const OBBTreeNodeImpl& copy);
-    ~OBBTreeNodeImpl();
+
+    bool isLeaf() const {return secondChildOffset == 0;}
+    const OBBTreeNodeImpl& getFirstChild() const 
+    {   assert(!isLeaf()); return this[1]; }
+    const OBBTreeNodeImpl& getSecondChild() const 
+    {   assert(!isLeaf()); return this[secondChildOffset]; }
+
     OrientedBoundingBox bounds;
-    OBBTreeNodeImpl* child1;
-    OBBTreeNodeImpl* child2;
-    Array_<int> triangles;
-    int numTriangles;
+    int                 secondChildOffset;  // 0 for a leaf
+    int                 firstTriangle;      // leaf only; index into tree
+    int                 numTriangles;       // in this node and below
+    Array_<int>         triangles;          // leaf only; view, see above
+
     Vec3 findNearestPoint(const ContactGeometry::TriangleMesh::Impl& mesh, 
                           const Vec3& position, Real cutoff2, Real& distance2, 
                           int& face, Vec2& uv) const;
@@ -1000,6 +1037,54 @@ public:
 
 
 
+//==============================================================================
+//                              OBB TREE IMPL
+//==============================================================================
+// The flattened OBBTree of a TriangleMesh: the node array described above
+// plus the leaf triangle lists they refer to. Built top-down, splitting each
+// node where the binned surface area heuristic says it is cheapest; large
+// meshes build their upper subtrees in parallel.
+class OBBTreeImpl {
+public:
+    OBBTreeImpl() {}
+    OBBTreeImpl(const OBBTreeImpl& src) 
+    :   nodes(src.nodes), triangles(src.triangles) {setLeafViews();}
+    OBBTreeImpl& operator=(const OBBTreeImpl& src) {
+        if (&src != this) {
+            nodes = src.nodes;
+            triangles = src.triangles;
+            setLeafViews();
+        }
+        return *this;
+    }
+
+    void build(const ContactGeometry::TriangleMesh::Impl& mesh);
+
+    const OBBTreeNodeImpl& getRoot() const {return nodes[0];}
+    int getNumNodes() const {return (int)nodes.size();}
+private:
+    class BuildSubtreeTask;
+
+    // Append the subtree for faceIndices[begin,end) to nodes and triangles.
+    // The face range is reordered in place.
+    static void buildSubtree(const ContactGeometry::TriangleMesh::Impl& mesh,
+                             const Array_<Vec3>& centroids,
+                             Array_<int>& faceIndices, int begin, int end,
+                             ParallelExecutor* executor,
+                             Array_<OBBTreeNodeImpl>& nodes, 
+                             Array_<int>& triangles);
+    static int splitFaces(const ContactGeometry::TriangleMesh::Impl& mesh,
+                          const Array_<Vec3>& centroids,
+                          const OrientedBoundingBox& bounds,
+                          Array_<int>& faceIndices, int begin, int end);
+    void setLeafViews();
+
+    Array_<OBBTreeNodeImpl> nodes;      // depth first; root is nodes[0]
+    Array_<int>             triangles;  // leaf triangle lists, in leaf order
+};
+
+
+
 //==============================================================================
 //                            TRIANGLE MESH IMPL
 //==============================================================================
@@ -1029,6 +1114,15 @@ public:
     DecorativeGeometry createDecorativeGeometry() const override;
     Vec3 findNearestPoint(const Vec3& position, bool& inside, 
                           UnitVec3& normal) const override;
+    void findNearestPoints(const ArrayViewConst_<Vec3>& positions,
+                           ArrayView_<Vec3>&            points,
+                           ArrayView_<bool>&            inside,
+                           ArrayView_<UnitVec3>&        normals) const override;
+    void findNearestPoints(const ArrayViewConst_<Vec3>& positions,
+                           ArrayView_<int>&             faces,
+                           ArrayView_<Vec3>&            points,
+                           ArrayView_<bool>&            inside,
+                           ArrayView_<Vec2>&            uvs) const;
     bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
                        Real& distance, UnitVec3& normal) const override;
     bool intersectsRay(const Vec3& origin, const UnitVec3& direction, 
@@ -1047,21 +1141,18 @@ public:
     }
 private:
     void init(const Array_<Vec3>& vertexPositions, const Array_<int>& faceIndices);
-    void createObbTree(OBBTreeNodeImpl& node, const Array_<int>& faceIndices);
-    void splitObbAxis(const Array_<int>& parentIndices, 
-                      Array_<int>& child1Indices, 
-                      Array_<int>& child2Indices, int axis);
     void findBoundingSphere(Vec3* point[], int p, int b, 
                             Vec3& center, Real& radius);
     friend class ContactGeometry::TriangleMesh;
     friend class OBBTreeNodeImpl;
+    friend class OBBTreeImpl;
 
     Array_<Edge>    edges;
     Array_<Face>    faces;
     Array_<Vertex>  vertices;
     Vec3            boundingSphereCenter;
     Real            boundingSphereRadius;
-    OBBTreeNodeImpl obb;
+    OBBTreeImpl     obb;
     bool            smooth;
 };
 
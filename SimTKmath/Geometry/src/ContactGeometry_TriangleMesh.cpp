@@ -30,9 +30,11 @@
 
 #include "ContactGeometryImpl.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 #include <map>
+#include <memory>
 #include <set>
 
 using namespace SimTK;
@@ -166,6 +168,26 @@ Vec3 ContactGeometry::TriangleMesh::findNearestPoint
     return getImpl().findNearestPoint(position, inside, face, uv);
 }
 
+void ContactGeometry::TriangleMesh::findNearestPoints
+   (const ArrayViewConst_<Vec3>& positions, ArrayView_<Vec3>& points,
+    ArrayView_<bool>& inside, ArrayView_<UnitVec3>& normals) const {
+    ContactGeometry::findNearestPoints(positions, points, inside, normals);
+}
+
+void ContactGeometry::TriangleMesh::findNearestPoints
+   (const ArrayViewConst_<Vec3>& positions, ArrayView_<int>& faces,
+    ArrayView_<Vec3>& points, ArrayView_<bool>& inside,
+    ArrayView_<Vec2>& uvs) const {
+    const unsigned n = positions.size();
+    SimTK_APIARGCHECK5_ALWAYS(faces.size() == n && points.size() == n
+        && inside.size() == n && uvs.size() == n,
+        "ContactGeometry::TriangleMesh", "findNearestPoints",
+        "Got %u positions but %u faces, %u points, %u inside flags and %u uvs.",
+        n, (unsigned)faces.size(), (unsigned)points.size(),
+        (unsigned)inside.size(), (unsigned)uvs.size());
+    getImpl().findNearestPoints(positions, faces, points, inside, uvs);
+}
+
 Vec3 ContactGeometry::TriangleMesh::findNearestPointToFace
    (const Vec3& position, int face, Vec2& uv) const {
     return getImpl().findNearestPointToFace(position, face, uv);
@@ -185,7 +207,7 @@ bool ContactGeometry::TriangleMesh::intersectsRay
 
 ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::getOBBTreeNode() const {
-    return OBBTreeNode(getImpl().obb);
+    return OBBTreeNode(getImpl().obb.getRoot());
 }
 
 PolygonalMesh ContactGeometry::TriangleMesh::createPolygonalMesh() const {
@@ -257,12 +279,61 @@ Vec3 ContactGeometry::TriangleMesh::Impl::
 findNearestPoint(const Vec3& position, bool& inside, int& face, Vec2& uv) const 
 {
     Real distance2;
-    Vec3 nearestPoint = obb.findNearestPoint(*this, position, MostPositiveReal, distance2, face, uv);
+    Vec3 nearestPoint = obb.getRoot().findNearestPoint(*this, position, MostPositiveReal, distance2, face, uv);
     Vec3 delta = position-nearestPoint;
     inside = (~delta*faces[face].normal < 0);
     return nearestPoint;
 }
 
+void ContactGeometry::TriangleMesh::Impl::
+findNearestPoints(const ArrayViewConst_<Vec3>& positions, 
+                  ArrayView_<Vec3>& points, ArrayView_<bool>& inside,
+                  ArrayView_<UnitVec3>& normals) const {
+    Array_<int> faces(positions.size(), -1);
+    Array_<Vec2> uvs(positions.size());
+    findNearestPoints(positions, faces, points, inside, uvs);
+    for (unsigned i = 0; i < positions.size(); ++i)
+        normals[i] = findNormalAtPoint(faces[i], uvs[i]);
+}
+
+// Each query first measures the distance to the guessed face and to the face
+// found for the previous point, and uses the smaller as a cutoff so that the
+// tree search skips every node that can't hold anything closer. The cutoff is
+// padded by more than the tie tolerance used in OBBTreeNodeImpl so that the
+// pruned nodes could not have won a tie either, which keeps the answers
+// identical to findNearestPoint(). If nothing beats the cutoff (the guess was
+// exactly on the surface, say) we fall back to the full search.
+void ContactGeometry::TriangleMesh::Impl::
+findNearestPoints(const ArrayViewConst_<Vec3>& positions, 
+                  ArrayView_<int>& faces, ArrayView_<Vec3>& points,
+                  ArrayView_<bool>& inside, ArrayView_<Vec2>& uvs) const {
+    const int numFaces = (int)this->faces.size();
+    int previousFace = -1;
+    for (unsigned i = 0; i < positions.size(); ++i) {
+        const Vec3& position = positions[i];
+        Real cutoff2 = MostPositiveReal;
+        for (int guess : {faces[i], previousFace}) {
+            if (guess < 0 || guess >= numFaces)
+                continue;
+            Vec2 uv;
+            const Vec3 p = findNearestPointToFace(position, guess, uv);
+            cutoff2 = std::min(cutoff2, (p-position).normSqr());
+        }
+        if (cutoff2 != MostPositiveReal)
+            cutoff2 *= 1+1000*Eps;
+
+        const OBBTreeNodeImpl& root = obb.getRoot();
+        Real distance2;
+        points[i] = root.findNearestPoint(*this, position, cutoff2, distance2,
+                                          faces[i], uvs[i]);
+        if (distance2 == MostPositiveReal)
+            points[i] = root.findNearestPoint(*this, position, MostPositiveReal,
+                                              distance2, faces[i], uvs[i]);
+        inside[i] = (~(position-points[i])*this->faces[faces[i]].normal < 0);
+        previousFace = faces[i];
+    }
+}
+
 bool ContactGeometry::TriangleMesh::Impl::
 intersectsRay(const Vec3& origin, const UnitVec3& direction, Real& distance, 
               UnitVec3& normal) const {
@@ -278,9 +349,10 @@ bool ContactGeometry::TriangleMesh::Impl::
 intersectsRay(const Vec3& origin, const UnitVec3& direction, Real& distance, 
               int& face, Vec2& uv) const {
     Real boundsDistance;
-    if (!obb.bounds.intersectsRay(origin, direction, boundsDistance))
+    const OBBTreeNodeImpl& root = obb.getRoot();
+    if (!root.bounds.intersectsRay(origin, direction, boundsDistance))
         return false;
-    return obb.intersectsRay(*this, origin, direction, distance, face, uv);
+    return root.intersectsRay(*this, origin, direction, distance, face, uv);
 }
 
 void ContactGeometry::TriangleMesh::Impl::
@@ -373,7 +445,7 @@ ContactGeometry::TriangleMesh::Impl::Impl
     // face's normal will be pointing back at us. If it is wrong, the face 
     // normal will also be pointing inwards, in roughly the same direction as 
     // the ray.
-    origin -= max(obb.bounds.getSize())*direction;
+    origin -= max(obb.getRoot().bounds.getSize())*direction;
     Real distance;
     int face;
     Vec2 uv;
@@ -531,10 +603,7 @@ void ContactGeometry::TriangleMesh::Impl::init
     
     // Create the OBBTree.
     
-    Array_<int> allFaces(faces.size());
-    for (int i = 0; i < (int) allFaces.size(); i++)
-        allFaces[i] = i;
-    createObbTree(obb, allFaces);
+    obb.build(*this);
     
     // Find the bounding sphere.
     Array_<const Vec3*> points(vertices.size());
@@ -545,120 +614,6 @@ void ContactGeometry::TriangleMesh::Impl::init
     boundingSphereRadius = bnd.getRadius();
 }
 
-void ContactGeometry::TriangleMesh::Impl::createObbTree
-   (OBBTreeNodeImpl& node, const Array_<int>& faceIndices) 
-{   // Find all vertices in the node and build the OrientedBoundingBox.
-    node.numTriangles = faceIndices.size();
-    set<int> vertexIndices;
-    for (int i = 0; i < (int) faceIndices.size(); i++) 
-        for (int j = 0; j < 3; j++)
-            vertexIndices.insert(faces[faceIndices[i]].vertices[j]);
-    Vector_<Vec3> points((int)vertexIndices.size());
-    int index = 0;
-    for (set<int>::iterator iter = vertexIndices.begin(); 
-                            iter != vertexIndices.end(); ++iter)
-        points[index++] = vertices[*iter].pos;
-    node.bounds = OrientedBoundingBox(points);
-    if (faceIndices.size() > 3) {
-
-        // Order the axes by size.
-
-        int axisOrder[3];
-        const Vec3& size = node.bounds.getSize();
-        if (size[0] > size[1]) {
-            if (size[0] > size[2]) {
-                axisOrder[0] = 0;
-                if (size[1] > size[2]) {
-                    axisOrder[1] = 1;
-                    axisOrder[2] = 2;
-                }
-                else {
-                    axisOrder[1] = 2;
-                    axisOrder[2] = 1;
-                }
-            }
-            else {
-                axisOrder[0] = 2;
-                axisOrder[1] = 0;
-                axisOrder[2] = 1;
-            }
-        }
-        else if (size[0] > size[2]) {
-            axisOrder[0] = 1;
-            axisOrder[1] = 0;
-            axisOrder[2] = 2;
-        }
-        else {
-            if (size[1] > size[2]) {
-                axisOrder[0] = 1;
-                axisOrder[1] = 2;
-            }
-            else {
-                axisOrder[0] = 2;
-                axisOrder[1] = 1;
-            }
-            axisOrder[2] = 0;
-        }
-
-        // Try splitting along each axis.
-
-        for (int i = 0; i < 3; i++) {
-            Array_<int> child1Indices, child2Indices;
-            splitObbAxis(faceIndices, child1Indices, child2Indices, 
-                         axisOrder[i]);
-            if (child1Indices.size() > 0 && child2Indices.size() > 0) {
-                // It was successfully split, so create the child nodes.
-
-                node.child1 = new OBBTreeNodeImpl();
-                node.child2 = new OBBTreeNodeImpl();
-                createObbTree(*node.child1, child1Indices);
-                createObbTree(*node.child2, child2Indices);
-                return;
-            }
-        }
-    }
-    
-    // This is a leaf node.
-    
-    node.triangles.insert(node.triangles.begin(), faceIndices.begin(), 
-                          faceIndices.end());
-}
-
-void ContactGeometry::TriangleMesh::Impl::splitObbAxis
-   (const Array_<int>& parentIndices, Array_<int>& child1Indices, 
-    Array_<int>& child2Indices, int axis) 
-{   // For each face, find its minimum and maximum extent along the axis.
-    Vector minExtent(parentIndices.size());
-    Vector maxExtent(parentIndices.size());
-    for (int i = 0; i < (int) parentIndices.size(); i++) {
-        int* vertexIndices = faces[parentIndices[i]].vertices;
-        Real minVal = vertices[vertexIndices[0]].pos[axis];
-        Real maxVal = vertices[vertexIndices[0]].pos[axis];
-        minVal = std::min(minVal, vertices[vertexIndices[1]].pos[axis]);
-        maxVal = std::max(maxVal, vertices[vertexIndices[1]].pos[axis]);
-        minExtent[i] = std::min(minVal, vertices[vertexIndices[2]].pos[axis]);
-        maxExtent[i] = std::max(maxVal, vertices[vertexIndices[2]].pos[axis]);
-    }
-    
-    // Select a split point that tries to put as many faces as possible 
-    // entirely on one side or the other.
-    
-    Real split = (median(minExtent)+median(maxExtent)) / 2;
-    
-    // Choose a side for each face.
-    
-    for (int i = 0; i < (int) parentIndices.size(); i++) {
-        if (maxExtent[i] <= split)
-            child1Indices.push_back(parentIndices[i]);
-        else if (minExtent[i] >= split)
-            child2Indices.push_back(parentIndices[i]);
-        else if (0.5*(minExtent[i]+maxExtent[i]) <= split)
-            child1Indices.push_back(parentIndices[i]);
-        else
-            child2Indices.push_back(parentIndices[i]);
-    }
-}
-
 Vec3 ContactGeometry::TriangleMesh::Impl::findNearestPointToFace
    (const Vec3& position, int face, Vec2& uv) const {
     // Calculate the distance between a point in space and a face of the mesh.
@@ -768,62 +723,333 @@ Vec3 ContactGeometry::TriangleMesh::Impl::findNearestPointToFace
 
 
 //==============================================================================
-//                            OBB TREE NODE IMPL
+//                               OBB TREE IMPL
 //==============================================================================
 
-OBBTreeNodeImpl::OBBTreeNodeImpl(const OBBTreeNodeImpl& copy) 
-:   bounds(copy.bounds), triangles(copy.triangles), 
-    numTriangles(copy.numTriangles) {
-    if (copy.child1 == NULL) {
-        child1 = NULL;
-        child2 = NULL;
+// Meshes (and subtrees) with at least this many faces are built in parallel.
+static const int OBBTreeParallelBuildMinFaces = 4096;
+
+// Number of buckets used to evaluate candidate splits along each axis.
+static const int OBBTreeNumSplitBins = 16;
+
+// Half the surface area of an axis-aligned box; only ratios matter here.
+static Real calcHalfArea(const Vec3& lo, const Vec3& hi) {
+    const Vec3 d = hi-lo;
+    return d[0]*d[1] + d[1]*d[2] + d[2]*d[0];
+}
+
+// Append a separately built subtree, shifting its leaves' triangle ranges to
+// account for the triangles already present. Child offsets are relative so
+// need no adjustment.
+static void appendSubtree(const Array_<OBBTreeNodeImpl>& subNodes,
+                          const Array_<int>& subTriangles,
+                          Array_<OBBTreeNodeImpl>& nodes,
+                          Array_<int>& triangles) {
+    const int triangleBase = (int)triangles.size();
+    for (const OBBTreeNodeImpl& node : subNodes) {
+        nodes.push_back(node);
+        if (node.isLeaf())
+            nodes.back().firstTriangle += triangleBase;
     }
-    else {
-        child1 = new OBBTreeNodeImpl(*copy.child1);
-        child2 = new OBBTreeNodeImpl(*copy.child2);
+    triangles.insert(triangles.end(), subTriangles.begin(), 
+                     subTriangles.end());
+}
+
+class OBBTreeImpl::BuildSubtreeTask : public ParallelExecutor::Task {
+public:
+    BuildSubtreeTask(const ContactGeometry::TriangleMesh::Impl& mesh,
+                     const Array_<Vec3>& centroids, Array_<int>& faceIndices,
+                     int begin, int mid, int end, ParallelExecutor* executor)
+    :   mesh(mesh), centroids(centroids), faceIndices(faceIndices),
+        executor(executor) {
+        ranges[0] = begin; ranges[1] = mid; ranges[2] = end;
+    }
+    // The two halves touch disjoint ranges of faceIndices.
+    void execute(int child) override {
+        buildSubtree(mesh, centroids, faceIndices, 
+                     ranges[child], ranges[child+1], executor, 
+                     nodes[child], triangles[child]);
+    }
+
+    Array_<OBBTreeNodeImpl> nodes[2];
+    Array_<int>             triangles[2];
+private:
+    const ContactGeometry::TriangleMesh::Impl& mesh;
+    const Array_<Vec3>&     centroids;
+    Array_<int>&            faceIndices;
+    int                     ranges[3];
+    ParallelExecutor*       executor;
+};
+
+void OBBTreeImpl::build(const ContactGeometry::TriangleMesh::Impl& mesh) {
+    const int numFaces = (int)mesh.faces.size();
+    Array_<Vec3> centroids(numFaces);
+    Array_<int> faceIndices(numFaces);
+    for (int i = 0; i < numFaces; i++) {
+        const int* v = mesh.faces[i].vertices;
+        centroids[i] = (mesh.vertices[v[0]].pos + mesh.vertices[v[1]].pos
+                        + mesh.vertices[v[2]].pos) / 3;
+        faceIndices[i] = i;
+    }
+
+    std::unique_ptr<ParallelExecutor> executor;
+    if (numFaces >= OBBTreeParallelBuildMinFaces 
+        && ParallelExecutor::getNumProcessors() > 1)
+        executor.reset(new ParallelExecutor());
+
+    nodes.clear();
+    triangles.clear();
+    // A binary tree with at least one triangle per leaf.
+    nodes.reserve(std::max(2*numFaces-1, 1));
+    triangles.reserve(numFaces);
+    buildSubtree(mesh, centroids, faceIndices, 0, numFaces, executor.get(),
+                 nodes, triangles);
+    setLeafViews();
+}
+
+void OBBTreeImpl::buildSubtree
+   (const ContactGeometry::TriangleMesh::Impl& mesh,
+    const Array_<Vec3>& centroids, Array_<int>& faceIndices, 
+    int begin, int end, ParallelExecutor* executor,
+    Array_<OBBTreeNodeImpl>& nodes, Array_<int>& triangles) 
+{   // Fit the OrientedBoundingBox to the distinct vertices of these faces.
+    Array_<int> vertexIndices;
+    vertexIndices.reserve(3*(end-begin));
+    for (int i = begin; i < end; i++)
+        for (int j = 0; j < 3; j++)
+            vertexIndices.push_back(mesh.faces[faceIndices[i]].vertices[j]);
+    std::sort(vertexIndices.begin(), vertexIndices.end());
+    vertexIndices.erase(std::unique(vertexIndices.begin(), 
+                                    vertexIndices.end()),
+                        vertexIndices.end());
+    Vector_<Vec3> points((int)vertexIndices.size());
+    for (int i = 0; i < (int)vertexIndices.size(); i++)
+        points[i] = mesh.vertices[vertexIndices[i]].pos;
+
+    // Don't hold a reference to the node; appending children may move it.
+    const int index = (int)nodes.size();
+    nodes.push_back(OBBTreeNodeImpl());
+    nodes[index].bounds = OrientedBoundingBox(points);
+    nodes[index].numTriangles = end-begin;
+
+    if (end-begin > 3) {
+        const int mid = splitFaces(mesh, centroids, nodes[index].bounds, 
+                                   faceIndices, begin, end);
+        if (executor && end-begin >= OBBTreeParallelBuildMinFaces) {
+            BuildSubtreeTask task(mesh, centroids, faceIndices, 
+                                  begin, mid, end, executor);
+            executor->execute(task, 2);
+            appendSubtree(task.nodes[0], task.triangles[0], nodes, triangles);
+            nodes[index].secondChildOffset = (int)nodes.size()-index;
+            appendSubtree(task.nodes[1], task.triangles[1], nodes, triangles);
+        }
+        else {
+            buildSubtree(mesh, centroids, faceIndices, begin, mid, executor,
+                         nodes, triangles);
+            nodes[index].secondChildOffset = (int)nodes.size()-index;
+            buildSubtree(mesh, centroids, faceIndices, mid, end, executor,
+                         nodes, triangles);
+        }
+        return;
+    }
+
+    // This is a leaf node.
+
+    nodes[index].firstTriangle = (int)triangles.size();
+    triangles.insert(triangles.end(), faceIndices.begin()+begin, 
+                     faceIndices.begin()+end);
+}
+
+// Reorder faceIndices[begin,end) into two nonempty groups and return where
+// the second one starts. Faces are binned by the position of their centroids
+// along each axis of the node's box, and we take the bin boundary that 
+// minimizes the surface area heuristic: the sum over both sides of the
+// number of faces times the area of a box (aligned with the parent's) that
+// holds them. If the centroids can't be told apart we split at the median.
+int OBBTreeImpl::splitFaces
+   (const ContactGeometry::TriangleMesh::Impl& mesh,
+    const Array_<Vec3>& centroids, const OrientedBoundingBox& bounds,
+    Array_<int>& faceIndices, int begin, int end) 
+{
+    const int NB = OBBTreeNumSplitBins;
+    const int n = end-begin;
+    const Rotation& R = bounds.getTransform().R();
+
+    // The box-frame extent of each face.
+    Array_<Vec3> faceLo(n), faceHi(n);
+    for (int i = 0; i < n; i++) {
+        const int* v = mesh.faces[faceIndices[begin+i]].vertices;
+        faceLo[i] = faceHi[i] = ~R*mesh.vertices[v[0]].pos;
+        for (int j = 1; j < 3; j++) {
+            const Vec3 p = ~R*mesh.vertices[v[j]].pos;
+            for (int k = 0; k < 3; k++) {
+                faceLo[i][k] = std::min(faceLo[i][k], p[k]);
+                faceHi[i][k] = std::max(faceHi[i][k], p[k]);
+            }
+        }
+    }
+
+    Real bestCost = Infinity;
+    int bestAxis = -1, bestBin = -1;
+    Real bestMin = 0, bestScale = 0;
+    Array_<Real> key(n);
+    for (int axis = 0; axis < 3; axis++) {
+        const UnitVec3& dir = R.col(axis);
+        Real keyMin = Infinity, keyMax = -Infinity;
+        for (int i = 0; i < n; i++) {
+            key[i] = ~dir*centroids[faceIndices[begin+i]];
+            keyMin = std::min(keyMin, key[i]);
+            keyMax = std::max(keyMax, key[i]);
+        }
+        if (!(keyMax > keyMin))
+            continue;
+        const Real scale = NB/(keyMax-keyMin);
+
+        int count[NB] = {0};
+        Vec3 lo[NB], hi[NB];
+        for (int b = 0; b < NB; b++) {
+            lo[b] = Vec3(Infinity);
+            hi[b] = Vec3(-Infinity);
+        }
+        for (int i = 0; i < n; i++) {
+            const int b = std::min(NB-1, int((key[i]-keyMin)*scale));
+            ++count[b];
+            for (int k = 0; k < 3; k++) {
+                lo[b][k] = std::min(lo[b][k], faceLo[i][k]);
+                hi[b][k] = std::max(hi[b][k], faceHi[i][k]);
+            }
+        }
+
+        // Sweep from the right to get the cost of everything above each
+        // boundary, then from the left to finish the sums.
+        Real rightCost[NB];
+        Vec3 runLo(Infinity), runHi(-Infinity);
+        int runCount = 0;
+        for (int b = NB-1; b > 0; b--) {
+            runCount += count[b];
+            for (int k = 0; k < 3; k++) {
+                runLo[k] = std::min(runLo[k], lo[b][k]);
+                runHi[k] = std::max(runHi[k], hi[b][k]);
+            }
+            rightCost[b] = runCount ? runCount*calcHalfArea(runLo, runHi) 
+                                    : Infinity;
+        }
+        runLo = Vec3(Infinity); runHi = Vec3(-Infinity);
+        runCount = 0;
+        for (int b = 0; b < NB-1; b++) {
+            runCount += count[b];
+            for (int k = 0; k < 3; k++) {
+                runLo[k] = std::min(runLo[k], lo[b][k]);
+                runHi[k] = std::max(runHi[k], hi[b][k]);
+            }
+            if (runCount == 0 || runCount == n)
+                continue;
+            const Real cost = runCount*calcHalfArea(runLo, runHi) 
+                              + rightCost[b+1];
+            if (cost < bestCost) {
+                bestCost  = cost;
+                bestAxis  = axis;
+                bestBin   = b;
+                bestMin   = keyMin;
+                bestScale = scale;
+            }
+        }
     }
+
+    if (bestAxis < 0) {
+        // All the centroids coincide; any even split will do.
+        return begin + n/2;
+    }
+
+    // Recompute the keys for the chosen axis exactly as they were binned.
+    const UnitVec3& dir = R.col(bestAxis);
+    Array_<int> second;
+    second.reserve(n);
+    int numFirst = 0;
+    for (int i = 0; i < n; i++) {
+        const int f = faceIndices[begin+i];
+        const Real k = ~dir*centroids[f];
+        const int b = std::min(NB-1, int((k-bestMin)*bestScale));
+        if (b <= bestBin)
+            faceIndices[begin + numFirst++] = f;
+        else
+            second.push_back(f);
+    }
+    std::copy(second.begin(), second.end(), 
+              faceIndices.begin() + begin + numFirst);
+    return begin + numFirst;
 }
 
-OBBTreeNodeImpl::~OBBTreeNodeImpl() {
-    if (child1 != NULL)
-        delete child1;
-    if (child2 != NULL)
-        delete child2;
+void OBBTreeImpl::setLeafViews() {
+    for (OBBTreeNodeImpl& node : nodes) {
+        if (node.isLeaf()) {
+            int* first = triangles.begin() + node.firstTriangle;
+            node.triangles.shareData(first, first + node.numTriangles);
+        }
+        else 
+            node.triangles.deallocate();
+    }
 }
 
+// Squared distance from a point to a box, zero if it is inside. Cheaper than
+// going through OrientedBoundingBox::findNearestPoint() since we don't need
+// to map the nearest point back out of the box frame.
+static Real calcDistance2ToBox(const OrientedBoundingBox& box, 
+                               const Vec3& position) {
+    const Vec3 p = ~box.getTransform()*position;
+    const Vec3& size = box.getSize();
+    Real distance2 = 0;
+    for (int i = 0; i < 3; i++) {
+        if (p[i] < 0)
+            distance2 += square(p[i]);
+        else if (p[i] > size[i])
+            distance2 += square(p[i]-size[i]);
+    }
+    return distance2;
+}
+
+
+
+//==============================================================================
+//                            OBB TREE NODE IMPL
+//==============================================================================
+
 Vec3 OBBTreeNodeImpl::findNearestPoint
    (const ContactGeometry::TriangleMesh::Impl& mesh, 
     const Vec3& position, Real cutoff2, 
     Real& distance2, int& face, Vec2& uv) const 
 {
     Real tol = 100*Eps;
-    if (child1 != NULL) {
+    if (!isLeaf()) {
         // Recursively check the child nodes.
         
+        const OBBTreeNodeImpl& child1 = getFirstChild();
+        const OBBTreeNodeImpl& child2 = getSecondChild();
         Real child1distance2 = MostPositiveReal, 
              child2distance2 = MostPositiveReal;
         int child1face, child2face;
         Vec2 child1uv, child2uv;
         Vec3 child1point, child2point;
-        Real child1BoundsDist2 = 
-            (child1->bounds.findNearestPoint(position)-position).normSqr();
-        Real child2BoundsDist2 = 
-            (child2->bounds.findNearestPoint(position)-position).normSqr();
+        Real child1BoundsDist2 = calcDistance2ToBox(child1.bounds, position);
+        Real child2BoundsDist2 = calcDistance2ToBox(child2.bounds, position);
         if (child1BoundsDist2 < child2BoundsDist2) {
             if (child1BoundsDist2 < cutoff2) {
-                child1point = child1->findNearestPoint(mesh, position, cutoff2, child1distance2, child1face, child1uv);
+                child1point = child1.findNearestPoint(mesh, position, cutoff2, child1distance2, child1face, child1uv);
                 if (child2BoundsDist2 < child1distance2 && child2BoundsDist2 < cutoff2)
-                    child2point = child2->findNearestPoint(mesh, position, cutoff2, child2distance2, child2face, child2uv);
+                    child2point = child2.findNearestPoint(mesh, position, cutoff2, child2distance2, child2face, child2uv);
             }
         }
         else {
             if (child2BoundsDist2 < cutoff2) {
-                child2point = child2->findNearestPoint(mesh, position, cutoff2, child2distance2, child2face, child2uv);
+                child2point = child2.findNearestPoint(mesh, position, cutoff2, child2distance2, child2face, child2uv);
                 if (child1BoundsDist2 < child2distance2 && child1BoundsDist2 < cutoff2)
-                    child1point = child1->findNearestPoint(mesh, position, cutoff2, child1distance2, child1face, child1uv);
+                    child1point = child1.findNearestPoint(mesh, position, cutoff2, child1distance2, child1face, child1uv);
             }
         }
-        if (   child1distance2 <= child2distance2*(1+tol) 
+        // Both children may have been pruned by the cutoff, in which case
+        // there is nothing to compare.
+        if (   child1distance2 != MostPositiveReal
+            && child1distance2 <= child2distance2*(1+tol) 
             && child2distance2 <= child1distance2*(1+tol)) {
             // Decide based on angle which one to use.
             
@@ -870,34 +1096,36 @@ bool OBBTreeNodeImpl::
 intersectsRay(const ContactGeometry::TriangleMesh::Impl& mesh,
               const Vec3& origin, const UnitVec3& direction, Real& distance, 
               int& face, Vec2& uv) const {
-    if (child1 != NULL) {
+    if (!isLeaf()) {
         // Recursively check the child nodes.
         
+        const OBBTreeNodeImpl& child1 = getFirstChild();
+        const OBBTreeNodeImpl& child2 = getSecondChild();
         Real child1distance, child2distance;
         int child1face, child2face;
         Vec2 child1uv, child2uv;
-        bool child1intersects = child1->bounds.intersectsRay(origin, direction, child1distance);
-        bool child2intersects = child2->bounds.intersectsRay(origin, direction, child2distance);
+        bool child1intersects = child1.bounds.intersectsRay(origin, direction, child1distance);
+        bool child2intersects = child2.bounds.intersectsRay(origin, direction, child2distance);
         if (child1intersects) {
             if (child2intersects) {
                 // The ray intersects both child nodes.  First check the closer one.
                 
                 if (child1distance < child2distance) {
-                    child1intersects = child1->intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
+                    child1intersects = child1.intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
                     if (!child1intersects || child2distance < child1distance)
-                        child2intersects = child2->intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
+                        child2intersects = child2.intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
                 }
                 else {
-                    child2intersects = child2->intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
+                    child2intersects = child2.intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
                     if (!child2intersects || child1distance < child2distance)
-                        child1intersects = child1->intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
+                        child1intersects = child1.intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
                 }
             }
             else
-                child1intersects = child1->intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
+                child1intersects = child1.intersectsRay(mesh, origin,  direction, child1distance, child1face, child1uv);
         }
         else if (child2intersects)
-            child2intersects = child2->intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
+            child2intersects = child2.intersectsRay(mesh, origin,  direction, child2distance, child2face, child2uv);
         
         // If either one had an intersection, return the closer one.
         
@@ -1002,26 +1230,26 @@ ContactGeometry::TriangleMesh::OBBTreeNode::getBounds() const {
 }
 
 bool ContactGeometry::TriangleMesh::OBBTreeNode::isLeafNode() const {
-    return (impl->child1 == NULL);
+    return impl->isLeaf();
 }
 
 const ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::OBBTreeNode::getFirstChildNode() const {
-    SimTK_ASSERT_ALWAYS(impl->child1, 
+    SimTK_ASSERT_ALWAYS(!impl->isLeaf(), 
         "Called getFirstChildNode() on a leaf node");
-    return OBBTreeNode(*impl->child1);
+    return OBBTreeNode(impl->getFirstChild());
 }
 
 const ContactGeometry::TriangleMesh::OBBTreeNode 
 ContactGeometry::TriangleMesh::OBBTreeNode::getSecondChildNode() const {
-    SimTK_ASSERT_ALWAYS(impl->child2, 
-        "Called getFirstChildNode() on a leaf node");
-    return OBBTreeNode(*impl->child2);
+    SimTK_ASSERT_ALWAYS(!impl->isLeaf(), 
+        "Called getSecondChildNode() on a leaf node");
+    return OBBTreeNode(impl->getSecondChild());
 }
 
 const Array_<int>& ContactGeometry::TriangleMesh::OBBTreeNode::
 getTriangles() const {
-    SimTK_ASSERT_ALWAYS(impl->child2 == NULL, 
+    SimTK_ASSERT_ALWAYS(impl->isLeaf(), 
         "Called getTriangles() on a non-leaf node");
     return impl->triangles;
 }
@@ -0,0 +1,125 @@
+#ifndef SimTK_SIMMATH_BATCH_TIMESTEPPER_H_
+#define SimTK_SIMMATH_BATCH_TIMESTEPPER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simmath/internal/common.h"
+#include "simmath/Integrator.h"
+
+#include <functional>
+
+namespace SimTK {
+
+/**
+ * This class advances many States of the same System through time in 
+ * parallel, for example for parameter sweeps or Monte Carlo studies. The 
+ * System's topology must already have been realized, and each State must 
+ * have been obtained from it. For example:
+ * 
+ * <pre>
+ * BatchTimeStepper batch(system, [](const System& sys) {
+ *     auto integ = new RungeKuttaMersonIntegrator(sys);
+ *     integ->setAccuracy(1e-4);
+ *     return integ;
+ * });
+ * Array_<State> states(1000, system.getDefaultState());
+ * // ... modify the states ...
+ * Array_<BatchTimeStepper::Result> results;
+ * batch.stepTo(states, finalTime, results);
+ * </pre>
+ * 
+ * Each thread gets its own Integrator and TimeStepper, created with the
+ * supplied factory the first time that thread is used and then reused for
+ * every instance it advances, in this and later calls to stepTo(). Instances
+ * are assigned to threads dynamically so it's fine if some take much longer
+ * than others. An instance's State is copied into the Integrator when it 
+ * starts, since an Integrator always advances a State of its own. When the
+ * instance is done that State is moved back into the caller's array rather
+ * than copied (unless the Integrator's final State was interpolated). No other
+ * copies are made.
+ * 
+ * Everything the System does during realization or event handling must be
+ * safe to do concurrently for different States.
+ */
+class SimTK_SIMMATH_EXPORT BatchTimeStepper {
+public:
+    /**
+     * A function that creates a new Integrator for the given System, to be
+     * owned by the BatchTimeStepper.
+     */
+    typedef std::function<Integrator*(const System&)> IntegratorFactory;
+
+    /**
+     * What happened to one instance during a call to stepTo().
+     */
+    struct Result {
+        Result() : status(Integrator::InvalidSuccessfulStepStatus), 
+                   time(NaN), numStepsTaken(0), failed(false) {}
+        /** The status returned by the last TimeStepper::stepTo(). */
+        Integrator::SuccessfulStepStatus status;
+        /** The time reached; normally the requested final time. */
+        Real    time;
+        /** The number of integrator steps taken by this instance. */
+        int     numStepsTaken;
+        /** Whether the integration threw an exception. If so, the instance's
+         *  State is left as it was when stepTo() was called. */
+        bool    failed;
+        /** The exception message, if the integration failed. */
+        String  failureMessage;
+    };
+
+    /**
+     * Create a BatchTimeStepper to advance States of the given System.
+     * 
+     * @param system        the System to be advanced
+     * @param factory       creates the Integrator for each thread
+     * @param numThreads    the maximum number of threads to use
+     */
+    BatchTimeStepper(const System& system, const IntegratorFactory& factory,
+                     int numThreads = ParallelExecutor::getNumProcessors());
+    ~BatchTimeStepper();
+
+    /**
+     * Get the maximum number of threads this BatchTimeStepper will use.
+     */
+    int getNumThreads() const;
+
+    /**
+     * Advance every State in \a states to \a finalTime. When this returns 
+     * each State holds that instance's state at the time it reached, and
+     * \a results has one entry per State.
+     */
+    void stepTo(Array_<State>& states, Real finalTime, 
+                Array_<Result>& results);
+private:
+    class BatchTimeStepperRep* rep;
+    // Not copyable.
+    BatchTimeStepper(const BatchTimeStepper&);
+    BatchTimeStepper& operator=(const BatchTimeStepper&);
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_BATCH_TIMESTEPPER_H_
@@ -73,6 +73,24 @@ public:
      * again with a larger value will fail.
      */
     void setOrderLimit(int order);
+    /**
+     * Form the Newton iteration matrix from a sparse Jacobian. By default CPODES estimates df/dy by
+     * perturbing one state variable at a time, which costs one realization of the System per state
+     * variable. In sparse mode, the integrator finds which entries of df/dy are nonzero, groups state
+     * variables that never affect the same derivative, and perturbs each group at once, so a Jacobian
+     * costs one realization per group. This pays off for large systems made of loosely coupled parts.
+     * The pattern is found by a full one-at-a-time sweep, which is repeated periodically and whenever
+     * the integrator is reinitialized so that changes in coupling (e.g. contacts) are picked up.
+     * The linear solve itself is still dense.
+     *
+     * This method must be invoked before the integrator is initialized.  Invoking it after initialization
+     * will produce an exception.
+     */
+    void setUseSparseJacobian(bool useSparse);
+    /**
+     * Return whether setUseSparseJacobian() has been turned on.
+     */
+    bool getUseSparseJacobian() const;
 };
 
 } // namespace SimTK
@@ -69,7 +69,10 @@ public:
     virtual void errorHandler(int error_code, const char* module,
                               const char* function, char* msg) const;
 
-    //TODO: Jacobian functions
+    // Fill in the full Jacobian J=df/dy of an explicit ODE at (t,y), where
+    // fy=f(t,y) has already been evaluated. J arrives sized N x N.
+    virtual int  explicitJacobian(Real t, const Vector& y, const Vector& fy,
+                                  Matrix& J) const;
 };
 
 
@@ -111,6 +114,11 @@ static void errorHandler_static(const CPodesSystem& sys,
                                 const char* function, char* msg)
   { sys.errorHandler(error_code,module,function,msg); }
 
+static int explicitJacobian_static(const CPodesSystem& sys,
+                                   Real t, const Vector& y, const Vector& fy,
+                                   Matrix& J)
+  { return sys.explicitJacobian(t,y,fy,J); }
+
 /**
  * This is a straightforward translation of the Sundials CPODES C 
  * interface into C++. The class CPodes represents a single instance
@@ -247,6 +255,11 @@ public:
     // method from CPodesSystem.
     int setEwtFn();
 
+    // This tells the dense direct linear solver (which must already have
+    // been selected with lapackDense()) to use the user's explicitJacobian()
+    // method from CPodesSystem instead of its own difference quotients.
+    int dlsSetJacFn();
+
     // TODO: these routines should enable methods that are defined
     // in the CPodesSystem, but a proper interface to the Jacobian
     // routines hasn't been implemented yet.
@@ -366,6 +379,9 @@ private:
     typedef void (*ErrorHandlerFunc)(const CPodesSystem&, 
                                      int error_code, const char* module, 
                                      const char* function, char* msg);
+    typedef int (*ExplicitJacobianFunc)(const CPodesSystem&,
+                                        Real t, const Vector& y,
+                                        const Vector& fy, Matrix& J);
 
     // Note that these routines do not tell CPodes to use the supplied
     // functions. They merely provide the client-side addresses of functions
@@ -383,6 +399,7 @@ private:
     void registerRootFunc(RootFunc);
     void registerWeightFunc(WeightFunc);
     void registerErrorHandlerFunc(ErrorHandlerFunc);
+    void registerExplicitJacobianFunc(ExplicitJacobianFunc);
 
 
     // This is the library-side part of the CPodes constructor. This must
@@ -401,6 +418,7 @@ private:
         registerRootFunc(root_static);
         registerWeightFunc(weight_static);
         registerErrorHandlerFunc(errorHandler_static);
+        registerExplicitJacobianFunc(explicitJacobian_static);
     }
 
     // FOR INTERNAL USE ONLY
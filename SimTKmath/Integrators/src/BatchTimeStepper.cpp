@@ -0,0 +1,181 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * This is the private (library side) implementation of the Simmath
+ * BatchTimeStepper class.
+ */
+
+#include "SimTKcommon.h"
+#include "simmath/BatchTimeStepper.h"
+#include "simmath/TimeStepper.h"
+
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace SimTK {
+
+    //////////////////////////////////
+    // CLASS BATCH TIME STEPPER REP //
+    //////////////////////////////////
+
+class BatchTimeStepperRep {
+public:
+    BatchTimeStepperRep(const System& system, 
+                        const BatchTimeStepper::IntegratorFactory& factory,
+                        int numThreads)
+    :   system(system), factory(factory), executor(numThreads) {}
+
+    ~BatchTimeStepperRep() {
+        for (Workspace* ws : workspaces)
+            delete ws;
+    }
+
+    // An Integrator and TimeStepper that one thread uses for all the 
+    // instances it advances.
+    struct Workspace {
+        Workspace(const System& system, Integrator* integ)
+        :   integ(integ), stepper(system, *integ) {}
+        std::unique_ptr<Integrator> integ;
+        TimeStepper                 stepper;
+    };
+
+    // Get an idle Workspace, creating one if necessary.
+    Workspace* acquireWorkspace() {
+        std::lock_guard<std::mutex> lock(workspaceLock);
+        if (!idleWorkspaces.empty()) {
+            Workspace* ws = idleWorkspaces.back();
+            idleWorkspaces.pop_back();
+            return ws;
+        }
+        Integrator* integ = factory(system);
+        SimTK_ERRCHK_ALWAYS(integ != nullptr, "BatchTimeStepper::stepTo()",
+            "The IntegratorFactory returned a null Integrator.");
+        workspaces.push_back(new Workspace(system, integ));
+        return workspaces.back();
+    }
+
+    void releaseWorkspace(Workspace* ws) {
+        std::lock_guard<std::mutex> lock(workspaceLock);
+        idleWorkspaces.push_back(ws);
+    }
+
+    class StepToTask;
+
+    const System&                           system;
+    const BatchTimeStepper::IntegratorFactory factory;
+    ParallelExecutor                        executor;
+
+    std::mutex                              workspaceLock;
+    Array_<Workspace*>                      workspaces;     // owned
+    Array_<Workspace*>                      idleWorkspaces; // not owned
+};
+
+// Each thread grabs a Workspace when it executes its first instance and 
+// gives it back in finish(), so that the Workspaces are reused but never 
+// shared. We don't get the Workspace in initialize() because creating one
+// can fail, and the ParallelExecutor can't report that.
+class BatchTimeStepperRep::StepToTask : public ParallelExecutor::Task {
+public:
+    StepToTask(BatchTimeStepperRep& rep, Array_<State>& states, 
+               Real finalTime, Array_<BatchTimeStepper::Result>& results)
+    :   rep(rep), states(states), finalTime(finalTime), results(results),
+        workspace(nullptr) {}
+
+    void finish() override {
+        if (workspace.get())
+            rep.releaseWorkspace(workspace.get());
+        workspace.upd() = nullptr;
+    }
+    void execute(int index) override {
+        BatchTimeStepper::Result& result = results[index];
+        try {
+            if (!workspace.get())
+                workspace.upd() = rep.acquireWorkspace();
+            Workspace& ws = *workspace.get();
+            ws.integ->resetAllStatistics();
+            ws.stepper.initialize(states[index]);
+            result.status = ws.stepper.stepTo(finalTime);
+            // The Integrator doesn't need its advanced State after this; 
+            // initialize() will replace it for the next instance. So we can
+            // move it rather than copy it, unless the result is interpolated.
+            if (ws.integ->isStateInterpolated())
+                states[index] = ws.integ->getState();
+            else
+                states[index] = std::move(ws.integ->updAdvancedState());
+            result.time = states[index].getTime();
+            result.numStepsTaken = ws.integ->getNumStepsTaken();
+        } catch (const std::exception& e) {
+            result.failed = true;
+            result.failureMessage = e.what();
+        } catch (...) {
+            // The ParallelExecutor would swallow this silently.
+            result.failed = true;
+            result.failureMessage = "Unrecognized exception.";
+        }
+    }
+private:
+    BatchTimeStepperRep&                rep;
+    Array_<State>&                      states;
+    const Real                          finalTime;
+    Array_<BatchTimeStepper::Result>&   results;
+    ThreadLocal<Workspace*>             workspace;
+};
+
+    ////////////////////////////////////////////
+    // IMPLEMENTATION OF BATCH TIME STEPPER   //
+    ////////////////////////////////////////////
+
+BatchTimeStepper::BatchTimeStepper(const System& system, 
+                                   const IntegratorFactory& factory,
+                                   int numThreads) {
+    SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "BatchTimeStepper",
+        "BatchTimeStepper", "Number of threads must be positive.");
+    SimTK_APIARGCHECK_ALWAYS(bool(factory), "BatchTimeStepper",
+        "BatchTimeStepper", "An IntegratorFactory is required.");
+    SimTK_APIARGCHECK_ALWAYS(system.systemTopologyHasBeenRealized(), 
+        "BatchTimeStepper", "BatchTimeStepper", 
+        "The System's topology must have been realized.");
+    rep = new BatchTimeStepperRep(system, factory, numThreads);
+}
+
+BatchTimeStepper::~BatchTimeStepper() {
+    delete rep;
+    rep = 0;
+}
+
+int BatchTimeStepper::getNumThreads() const {
+    return rep->executor.getMaxThreads();
+}
+
+void BatchTimeStepper::stepTo(Array_<State>& states, Real finalTime, 
+                              Array_<Result>& results) {
+    results.clear();
+    results.resize(states.size());
+    BatchTimeStepperRep::StepToTask task(*rep, states, finalTime, results);
+    rep->executor.execute(task, (int)states.size());
+}
+
+} // namespace SimTK
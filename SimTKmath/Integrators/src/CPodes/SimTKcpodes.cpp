@@ -66,6 +66,7 @@ public:
     CPodes::RootFunc            rootFunc;
     CPodes::WeightFunc          weightFunc;
     CPodes::ErrorHandlerFunc    errorHandlerFunc;
+    CPodes::ExplicitJacobianFunc explicitJacobianFunc;
 
     void zeroFunctionPointers() {
         explicitODEFunc  = 0;
@@ -76,6 +77,7 @@ public:
         rootFunc         = 0;
         weightFunc       = 0;
         errorHandlerFunc = 0;
+        explicitJacobianFunc = 0;
     }
 
     void setMyHandle(CPodes& cp) {myHandle = &cp;}
@@ -183,6 +185,20 @@ static void errorHandlerWrapper(int error_code,
     return rep.errorHandlerFunc(rep.getCPodesSystem(), error_code,module,function,msg);
 }
 
+// The Jacobian is handed to us as a column-major Sundials dense matrix; we
+// present it to the user as a Matrix that shares that memory.
+static int explicitJacobianWrapper(int N, realtype t,
+                                   N_Vector nv_y, N_Vector nv_fy,
+                                   DlsMat Jac, void* jac_data,
+                                   N_Vector, N_Vector, N_Vector)
+{
+    const Vector& y    = N_Vector_SimTK::getVector(nv_y);
+    const Vector& fy   = N_Vector_SimTK::getVector(nv_fy);
+    Matrix J(N, N, (int)Jac->ldim, Jac->data);
+    const CPodesRep& rep = *reinterpret_cast<const CPodesRep*>(jac_data);
+    return rep.explicitJacobianFunc(rep.getCPodesSystem(), t, y, fy, J);
+}
+
 ////////////////////////////////////////
 // CLASS SimTK::CPodes IMPLEMENTATION //
 ////////////////////////////////////////
@@ -627,6 +643,10 @@ char* CPodes::getReturnFlagName(int flag) {
     return CPodeGetReturnFlagName(flag);
 }
 
+int CPodes::dlsSetJacFn() {
+    return CPDlsSetJacFn(updRep().cpode_mem, (void*)explicitJacobianWrapper,
+                         (void*)rep);
+}
 int CPodes::dlsSetJacFn(void* jac, void* jac_data) {
     return CPDlsSetJacFn(updRep().cpode_mem,jac,jac_data);
 }
@@ -708,6 +728,9 @@ void CPodes::registerWeightFunc(CPodes::WeightFunc f) {
 void CPodes::registerErrorHandlerFunc(CPodes::ErrorHandlerFunc f) {
     updRep().errorHandlerFunc = f;
 }
+void CPodes::registerExplicitJacobianFunc(CPodes::ExplicitJacobianFunc f) {
+    updRep().explicitJacobianFunc = f;
+}
 
 /////////////////////////////////
 // CPodesSystem IMPLEMENTATION //
@@ -757,6 +780,12 @@ void CPodesSystem::errorHandler(int, const char*, const char*, char*) const {
     SimTK_THROW2(Exception::UnimplementedVirtualMethod, "CPodesSystem", "errorHandler"); 
 }
 
+int CPodesSystem::explicitJacobian(Real, const Vector&, const Vector&,
+                                   Matrix&) const {
+    SimTK_THROW2(Exception::UnimplementedVirtualMethod, "CPodesSystem", "explicitJacobian"); 
+    return std::numeric_limits<int>::min();
+}
+
 } // namespace SimTK
 
 
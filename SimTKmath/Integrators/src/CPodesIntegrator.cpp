@@ -51,6 +51,17 @@ void CPodesIntegrator::setOrderLimit(int order) {
     cprep.setOrderLimit(order);
 }
 
+void CPodesIntegrator::setUseSparseJacobian(bool useSparse) {
+    CPodesIntegratorRep& cprep = dynamic_cast<CPodesIntegratorRep&>(*rep);
+    cprep.setUseSparseJacobian(useSparse);
+}
+
+bool CPodesIntegrator::getUseSparseJacobian() const {
+    const CPodesIntegratorRep& cprep = 
+        dynamic_cast<const CPodesIntegratorRep&>(*rep);
+    return cprep.getUseSparseJacobian();
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -124,6 +135,16 @@ public:
         gout = integ.getAdvancedState().getEventTriggers();
         return CPodes::Success;
     }
+
+    // Only used in sparse Jacobian mode.
+    int explicitJacobian(Real t, const Vector& y, const Vector& fy,
+                         Matrix& J) const override {
+        try {
+            integ.calcSparseJacobian(t, y, fy, J);
+        }
+        catch(...) { return CPodes::RecoverableError; } // assume recoverable
+        return CPodes::Success;
+    }
 private:
     CPodesIntegratorRep& integ;
     const System& system;
@@ -137,6 +158,8 @@ void CPodesIntegratorRep::init
     cps = new CPodesSystemImpl(*this, getSystem());
     initialized = false;
     useCpodesProjection = false;
+    useSparseJacobian = false;
+    clearJacobianPattern();
 }
 
 CPodesIntegratorRep::CPodesIntegratorRep
@@ -190,6 +213,10 @@ void CPodesIntegratorRep::methodInitialize(const State& state) {
         SimTK_THROW1(Integrator::InitializationFailed, "init() failed");
     }
     cpodes->lapackDense(ny);
+    if (useSparseJacobian) {
+        clearJacobianPattern();
+        cpodes->dlsSetJacFn();
+    }
     cpodes->setNonlinConvCoef(Real(0.01)); // TODO (default is 0.1)
     if (useCpodesProjection) {
         const int nqerr = state.getNQErr(), nuerr = state.getNUErr();
@@ -235,6 +262,8 @@ void CPodesIntegratorRep::methodReinitialize
         cpodes->reInit(*cps, state.getTime(), 
                        Vector(state.getY()), Vector(state.getYDot()), 
                        CPodes::ScalarScalar, relTol, &absTol);
+        // The event may have changed which variables are coupled.
+        clearJacobianPattern();
     }
 }
 
@@ -643,4 +672,95 @@ void CPodesIntegratorRep::setOrderLimit(int order) {
     cpodes->setMaxOrd(order);
 }
 
+void CPodesIntegratorRep::setUseSparseJacobian(bool useSparse) {
+    SimTK_APIARGCHECK_ALWAYS(!initialized, "CPodesIntegrator", 
+        "setUseSparseJacobian",
+        "This method may not be invoked after the integrator has been initialized.");
+    useSparseJacobian = useSparse;
+}
+
+void CPodesIntegratorRep::clearJacobianPattern() {
+    jacobianRowsOfColumn.clear();
+    jacobianColumnGroups.clear();
+    numJacobiansSincePatternFound = 0;
+}
+
+// Fill in J=df/dy by forward differences. If we don't have a sparsity pattern
+// yet (or it is getting old) we perturb one column at a time and record which
+// rows respond; otherwise we perturb all the columns of a group together,
+// since by construction no two of them touch the same row.
+void CPodesIntegratorRep::
+calcSparseJacobian(Real t, const Vector& y, const Vector& fy, Matrix& J) {
+    // Rediscover the pattern every so often so that couplings that were
+    // numerically zero when we last looked don't stay lost forever.
+    const int PatternRefreshInterval = 50;
+
+    const int ny = y.size();
+    if (jacobianRowsOfColumn.size() != (unsigned)ny 
+        || numJacobiansSincePatternFound >= PatternRefreshInterval)
+        findJacobianPattern(t, y, fy, J);
+    ++numJacobiansSincePatternFound;
+
+    J = 0;
+    jacYPerturbed = y;
+    for (const Array_<int>& group : jacobianColumnGroups) {
+        for (int c : group)
+            jacYPerturbed[c] = y[c] + calcJacobianPerturbation(y[c]);
+        setAdvancedStateAndRealizeDerivatives(t, jacYPerturbed);
+        const Vector& fp = getAdvancedState().getYDot();
+        for (int c : group) {
+            const Real h = jacYPerturbed[c] - y[c];
+            for (int r : jacobianRowsOfColumn[c])
+                J(r,c) = (fp[r] - fy[r]) / h;
+            jacYPerturbed[c] = y[c];
+        }
+    }
+}
+
+// One column at a time; this is what CPODES would have done by itself. We
+// keep the Jacobian so the sweep isn't wasted, then greedily color the 
+// columns so that columns sharing a row never share a group.
+void CPodesIntegratorRep::
+findJacobianPattern(Real t, const Vector& y, const Vector& fy, Matrix& J) {
+    const int ny = y.size();
+    clearJacobianPattern(); // in case a realization throws
+    Array_<Array_<int> > rowsOfColumn(ny), columnsOfRow(ny);
+
+    jacYPerturbed = y;
+    for (int c=0; c < ny; ++c) {
+        jacYPerturbed[c] = y[c] + calcJacobianPerturbation(y[c]);
+        const Real h = jacYPerturbed[c] - y[c];
+        setAdvancedStateAndRealizeDerivatives(t, jacYPerturbed);
+        const Vector& fp = getAdvancedState().getYDot();
+        for (int r=0; r < ny; ++r) {
+            J(r,c) = (fp[r] - fy[r]) / h;
+            if (J(r,c) != 0) {
+                rowsOfColumn[c].push_back(r);
+                columnsOfRow[r].push_back(c);
+            }
+        }
+        jacYPerturbed[c] = y[c];
+    }
+
+    Array_<int> groupOfColumn(ny, -1);
+    Array_<int> lastColumnToUseGroup; // avoids clearing a "used" array
+    for (int c=0; c < ny; ++c) {
+        for (int r : rowsOfColumn[c])
+            for (int other : columnsOfRow[r])
+                if (groupOfColumn[other] >= 0)
+                    lastColumnToUseGroup[groupOfColumn[other]] = c;
+        int g = 0;
+        while (g < (int)jacobianColumnGroups.size() 
+               && lastColumnToUseGroup[g] == c)
+            ++g;
+        if (g == (int)jacobianColumnGroups.size()) {
+            jacobianColumnGroups.push_back(Array_<int>());
+            lastColumnToUseGroup.push_back(-1);
+        }
+        jacobianColumnGroups[g].push_back(c);
+        groupOfColumn[c] = g;
+    }
+    jacobianRowsOfColumn.swap(rowsOfColumn);
+}
+
 
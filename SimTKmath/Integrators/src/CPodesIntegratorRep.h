@@ -64,12 +64,16 @@ public:
     bool methodHasErrorControl() const override;
     void setUseCPodesProjection();
     void setOrderLimit(int order);
+    void setUseSparseJacobian(bool useSparse);
+    bool getUseSparseJacobian() const {return useSparseJacobian;}
+    void calcSparseJacobian(Real t, const Vector& y, const Vector& fy, 
+                            Matrix& J);
     class CPodesSystemImpl;
     friend class CPodesSystemImpl;
 private:
     CPodes* cpodes;
     CPodesSystemImpl* cps;
-    bool initialized, useCpodesProjection;
+    bool initialized, useCpodesProjection, useSparseJacobian;
     int statsStepsTaken, statsErrorTestFailures, statsConvergenceTestFailures;
     int statsIterations;
     int pendingReturnCode;
@@ -77,6 +81,19 @@ private:
     Vector savedY;
     CPodes::LinearMultistepMethod method;
     void init(CPodes::LinearMultistepMethod method, CPodes::NonlinearSystemIterationType iterationType);
+
+    // Sparse Jacobian mode. For each column of df/dy, the rows in which it
+    // has nonzeros; and a partition of the columns into groups whose rows
+    // don't overlap, so each group can be differenced with one realization.
+    Array_<Array_<int> > jacobianRowsOfColumn;
+    Array_<Array_<int> > jacobianColumnGroups;
+    int numJacobiansSincePatternFound;
+    Vector jacYPerturbed;
+    void clearJacobianPattern();
+    void findJacobianPattern(Real t, const Vector& y, const Vector& fy, 
+                             Matrix& J);
+    static Real calcJacobianPerturbation(Real yc)
+    {   return SqrtEps*std::max(std::abs(yc), Real(1)); }
 };
 
 } // namespace SimTK
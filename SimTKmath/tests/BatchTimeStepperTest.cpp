@@ -0,0 +1,105 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKmath.h"
+
+#include "PendulumSystem.h"
+
+#define ASSERT(cond) {SimTK_ASSERT_ALWAYS(cond, "Assertion failed");}
+
+using namespace SimTK;
+
+using std::cout;
+using std::endl;
+
+// Advance many pendulums with different initial speeds in parallel,
+// and check that each one ends up exactly where it does when advanced by
+// itself with the same kind of Integrator.
+int main () {
+  try {
+    PendulumSystem sys;
+    sys.realizeTopology();
+    const Real qi[] = {1,0}; // (x,y)=(1,0)
+    const Real ui[] = {0,0}; // v=0
+    sys.setDefaultTimeAndState(0, Vector(2, qi), Vector(2, ui));
+
+    auto factory = [](const System& system) {
+        Integrator* integ = new RungeKuttaMersonIntegrator(system);
+        integ->setAccuracy(1e-4);
+        integ->setConstraintTolerance(1e-6);
+        return integ;
+    };
+
+    const int numInstances = 50;
+    Array_<State> states(numInstances, sys.getDefaultState());
+    for (int i = 0; i < numInstances; ++i)
+        states[i].updU()[1] = -0.1*i;
+    const Array_<State> initStates = states;
+
+    BatchTimeStepper batch(sys, factory, 4);
+    ASSERT(batch.getNumThreads() == 4);
+    Array_<BatchTimeStepper::Result> results;
+    const Real tFinal = 3;
+    batch.stepTo(states, tFinal, results);
+    ASSERT(results.size() == numInstances);
+
+    for (int i = 0; i < numInstances; ++i) {
+        ASSERT(!results[i].failed);
+        ASSERT(results[i].time == tFinal);
+        ASSERT(results[i].numStepsTaken > 0);
+        ASSERT(states[i].getTime() == tFinal);
+
+        std::unique_ptr<Integrator> integ(factory(sys));
+        TimeStepper ts(sys, *integ);
+        ts.initialize(initStates[i]);
+        ts.stepTo(tFinal);
+        ASSERT((ts.getState().getY() - states[i].getY()).normInf() == 0);
+        ASSERT(integ->getNumStepsTaken() == results[i].numStepsTaken);
+    }
+
+    // Again, continuing from where we left off and reusing the workspaces.
+    batch.stepTo(states, 2*tFinal, results);
+    for (int i = 0; i < numInstances; ++i) {
+        ASSERT(!results[i].failed);
+        ASSERT(states[i].getTime() == 2*tFinal);
+    }
+
+    // Every instance must report failure if the Integrator can't be created,
+    // even if what's thrown isn't a std::exception.
+    BatchTimeStepper broken(sys, [](const System&) -> Integrator* {throw 42;},
+                            2);
+    broken.stepTo(states, 3*tFinal, results);
+    ASSERT(results.size() == numInstances);
+    for (int i = 0; i < numInstances; ++i) {
+        ASSERT(results[i].failed);
+        ASSERT(states[i].getTime() == 2*tFinal); // unchanged
+    }
+
+    cout << "Done" << endl;
+    return 0;
+  }
+  catch (std::exception& e) {
+    std::printf("FAILED: %s\n", e.what());
+    return 1;
+  }
+}
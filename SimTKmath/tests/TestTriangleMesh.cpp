@@ -24,6 +24,7 @@
 #include "SimTKmath.h"
 #include <vector>
 #include <exception>
+#include <memory>
 
 using namespace SimTK;
 using namespace std;
@@ -307,6 +308,104 @@ void testBoundingSphere() {
     }
 }
 
+// A mesh big enough that its OBBTree is built in parallel. Check the tree,
+// and check nearest points and ray hits against a brute force search over 
+// all the faces, both for the mesh and for a copy of it (whose leaves must 
+// refer to the copy's own triangle lists).
+void testLargeMesh() {
+    PolygonalMesh sphere = PolygonalMesh::createSphereMesh(1, 5);
+    std::unique_ptr<ContactGeometry::TriangleMesh> original
+        (new ContactGeometry::TriangleMesh(sphere));
+    SimTK_TEST(original->getNumFaces() > 4096);
+    ContactGeometry::TriangleMesh mesh(*original);
+    original.reset();
+
+    vector<int> faceReferenceCount(mesh.getNumFaces(), 0);
+    validateOBBTree(mesh, mesh.getOBBTreeNode(), mesh.getOBBTreeNode(), 
+                    faceReferenceCount);
+    for (int i = 0; i < (int) faceReferenceCount.size(); i++)
+        SimTK_TEST(faceReferenceCount[i] == 1);
+
+    Random::Gaussian random(0, 1);
+    random.setSeed(7);
+    for (int i = 0; i < 50; i++) {
+        const Vec3 pos(random.getValue(), random.getValue(), 
+                       random.getValue());
+        bool inside;
+        int face;
+        Vec2 uv;
+        const Vec3 nearest = mesh.findNearestPoint(pos, inside, face, uv);
+        Real bestDistance2 = Infinity;
+        for (int f = 0; f < mesh.getNumFaces(); f++) {
+            Vec2 fuv;
+            const Vec3 p = mesh.findNearestPointToFace(pos, f, fuv);
+            bestDistance2 = std::min(bestDistance2, (p-pos).normSqr());
+        }
+        SimTK_TEST_EQ((nearest-pos).normSqr(), bestDistance2);
+
+        // Shoot a ray from outside the sphere back through the point.
+        const UnitVec3 dir(-pos);
+        const Vec3 origin = 3*UnitVec3(pos);
+        Real distance;
+        UnitVec3 normal;
+        SimTK_TEST(mesh.intersectsRay(origin, dir, distance, normal));
+        SimTK_TEST(~normal*dir < 0);
+        SimTK_TEST_EQ_TOL((origin + distance*dir).norm(), 1, 0.01);
+    }
+}
+
+// The batched queries must give the same answers as one at a time, whatever
+// the face guesses are.
+void testFindNearestPoints() {
+    const ContactGeometry::TriangleMesh 
+        mesh(PolygonalMesh::createSphereMesh(1, 4));
+    Random::Gaussian random(0, 1);
+    random.setSeed(11);
+    const int n = 200;
+    Array_<Vec3> positions(n);
+    for (int i = 0; i < n; i++)
+        positions[i] = Vec3(random.getValue(), random.getValue(), 
+                            random.getValue());
+    positions[1] = positions[0]; // exactly repeated point
+    positions[2] = mesh.findCentroid(5); // exactly on the surface
+
+    Array_<int> faces(n, -1), bestFaces(n);
+    Array_<Vec3> points(n), bestPoints(n);
+    Array_<bool> inside(n), bestInside(n);
+    Array_<Vec2> uvs(n);
+    for (int i = 0; i < n; i++) {
+        bool isInside;
+        bestPoints[i] = mesh.findNearestPoint(positions[i], isInside, 
+                                              bestFaces[i], uvs[i]);
+        bestInside[i] = isInside;
+    }
+
+    // No guesses, then the answers as guesses, then bad guesses.
+    for (int pass = 0; pass < 3; pass++) {
+        if (pass == 2)
+            for (int i = 0; i < n; i++)
+                faces[i] = (37*i) % mesh.getNumFaces();
+        mesh.findNearestPoints(positions, faces, points, inside, uvs);
+        for (int i = 0; i < n; i++) {
+            SimTK_TEST(faces[i] == bestFaces[i]);
+            SimTK_TEST(points[i] == bestPoints[i]);
+            SimTK_TEST(inside[i] == bestInside[i]);
+        }
+    }
+
+    Array_<UnitVec3> normals(n);
+    const ContactGeometry& geom = mesh;
+    geom.findNearestPoints(positions, points, inside, normals);
+    for (int i = 0; i < n; i++) {
+        SimTK_TEST(points[i] == bestPoints[i]);
+        SimTK_TEST_EQ(normals[i], mesh.findNormalAtPoint(bestFaces[i], uvs[i]));
+    }
+
+    Array_<Vec2> shortUVs(n-1);
+    SimTK_TEST_MUST_THROW(mesh.findNearestPoints(positions, faces, points, 
+                                                 inside, shortUVs));
+}
+
 int main() {
     SimTK_START_TEST("TestTriangleMesh");
         SimTK_SUBTEST(testTriangleMesh);
@@ -316,5 +415,7 @@ int main() {
         SimTK_SUBTEST(testSmoothMesh);
         SimTK_SUBTEST(testFindNearestPoint);
         SimTK_SUBTEST(testBoundingSphere);
+        SimTK_SUBTEST(testLargeMesh);
+        SimTK_SUBTEST(testFindNearestPoints);
     SimTK_END_TEST();
 }
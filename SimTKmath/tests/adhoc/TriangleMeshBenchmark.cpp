@@ -0,0 +1,95 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Time TriangleMesh construction (dominated by building the OBBTree) and
+// nearest point and ray queries against it, for sphere meshes of increasing
+// size up to about 130k triangles. Pass a number of query points to change
+// the default.
+
+#include "SimTKmath.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+int main(int argc, char** argv) {
+    const int numQueries = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+    Random::Gaussian random(0, 1);
+    random.setSeed(42);
+    Array_<Vec3> points(numQueries);
+    for (Vec3& p : points)
+        p = Vec3(random.getValue(), random.getValue(), random.getValue());
+
+    cout << "faces      build(ms)  nearest(us)  ray(us)  nodes" << endl;
+    for (int resolution = 3; resolution <= 7; ++resolution) {
+        const PolygonalMesh sphere =
+            PolygonalMesh::createSphereMesh(1, resolution);
+
+        double start = realTime();
+        const ContactGeometry::TriangleMesh mesh(sphere);
+        const double buildTime = realTime()-start;
+
+        int numNodes = 0;
+        Array_<ContactGeometry::TriangleMesh::OBBTreeNode> stack;
+        stack.push_back(mesh.getOBBTreeNode());
+        while (!stack.empty()) {
+            const ContactGeometry::TriangleMesh::OBBTreeNode node =
+                stack.back();
+            stack.pop_back();
+            ++numNodes;
+            if (!node.isLeafNode()) {
+                stack.push_back(node.getFirstChildNode());
+                stack.push_back(node.getSecondChildNode());
+            }
+        }
+
+        Real sum = 0; // keep the optimizer honest
+        start = realTime();
+        for (const Vec3& p : points) {
+            bool inside;
+            UnitVec3 normal;
+            sum += mesh.findNearestPoint(p, inside, normal)[0];
+        }
+        const double nearestTime = realTime()-start;
+
+        start = realTime();
+        for (const Vec3& p : points) {
+            Real distance;
+            UnitVec3 normal;
+            if (mesh.intersectsRay(3*UnitVec3(p), UnitVec3(-p),
+                                   distance, normal))
+                sum += distance;
+        }
+        const double rayTime = realTime()-start;
+
+        cout << mesh.getNumFaces() << "\t   " << 1e3*buildTime
+             << "\t" << 1e6*nearestTime/numQueries
+             << "\t" << 1e6*rayTime/numQueries
+             << "\t" << numNodes
+             << (sum == 12345 ? " " : "") << endl;
+    }
+    return 0;
+}
@@ -63,6 +63,7 @@ will include this one). **/
 #include "simbody/internal/HuntCrossleyForce.h"
 #include "simbody/internal/DecorationSubsystem.h"
 #include "simbody/internal/TextDataEventReporter.h"
+#include "simbody/internal/TrajectoryReporter.h"
 #include "simbody/internal/ObservedPointFitter.h"
 #include "simbody/internal/Assembler.h"
 #include "simbody/internal/AssemblyCondition.h"
@@ -125,6 +125,21 @@ public:
      * Set the transition velocity (vt) of the friction model.
      */
     void setTransitionVelocity(Real v);
+    /**
+     * Set the number of threads that may be used to find the contact points
+     * of the springs. The nearest point queries for all the springs in a
+     * contact are independent, and for fine meshes they dominate the cost of
+     * this force. The default is 1, meaning everything is done on the calling
+     * thread. Small contacts are always done serially, as is everything when
+     * this force is itself being calculated on a worker thread (for example by
+     * a GeneralForceSubsystem with several threads of its own).
+     */
+    void setNumberOfThreads(unsigned numThreads);
+    /**
+     * Get the number of threads that may be used to find the contact points
+     * of the springs.
+     */
+    int getNumberOfThreads() const;
     SimTK_INSERT_DERIVED_HANDLE_DECLARATIONS(ElasticFoundationForce, ElasticFoundationForceImpl, Force);
 };
 
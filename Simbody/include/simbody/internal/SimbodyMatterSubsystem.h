@@ -205,6 +205,36 @@ void setShowDefaultGeometry(bool show);
 geometry that can be used to visualize this multibody system. **/
 bool getShowDefaultGeometry() const;
 
+/** Set the number of threads this matter subsystem may use for its recursive
+base-to-tip and tip-to-base tree computations (position kinematics, 
+articulated body inertias, forward and inverse dynamics, and M^-1*f). Bodies
+at the same level of the multibody tree are independent during these sweeps
+so they can be processed concurrently. The default is 1, meaning all 
+computations are done serially on the calling thread; that is usually best
+for small systems. Threads are created once and reused.
+
+A cost model decides level by level whether the parallel overhead is 
+worthwhile; see setParallelLevelCostThreshold(). Any Custom mobilizers in the
+System must be thread safe if you set this above 1.
+@see getNumberOfThreads() **/
+void setNumberOfThreads(unsigned numThreads);
+/** Return the number of threads this matter subsystem may use for its tree
+computations; 1 means they are done serially.
+@see setNumberOfThreads() **/
+int getNumberOfThreads() const;
+
+/** When more than one thread is in use (see setNumberOfThreads()), a level
+of the multibody tree is processed in parallel only if the estimated work for
+that level, in flops, is at least this threshold; otherwise it is done 
+serially. The estimate accounts for both the number of bodies in the level
+and the number of mobilities of their mobilizers. Smaller values make 
+parallel execution more likely. **/
+void setParallelLevelCostThreshold(Real flops);
+/** Return the current per-level cost threshold (in flops) below which tree
+levels are processed serially.
+@see setParallelLevelCostThreshold() **/
+Real getParallelLevelCostThreshold() const;
+
 /** The number of bodies includes all mobilized bodies \e including Ground,
 which is the first mobilized body, at MobilizedBodyIndex 0. (Note: if 
 special particle handling were implemented, the count here would \e not 
@@ -0,0 +1,151 @@
+#ifndef SimTK_SIMBODY_TRAJECTORY_REPORTER_H_
+#define SimTK_SIMBODY_TRAJECTORY_REPORTER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simbody/internal/common.h"
+
+#include <string>
+
+namespace SimTK {
+
+/** This is an EventReporter that records a trajectory to a compact binary
+file at regular intervals. Each sample contains the time, all the q's, u's,
+and z's, and the current values of any Real-valued Measures you select with
+addMeasure(). Use a TrajectoryReader to get the samples back, either as
+numbers or restored into a State, without rerunning the simulation.
+
+Samples are grouped into fixed-size chunks, each of which can optionally be
+compressed. Compression stores each value as its bitwise difference (XOR)
+from the same value in the previous sample, with the leading zero bytes
+dropped. That is lossless and works well when the reporting interval is short
+compared to the time scale of the motion. An index of the chunks is written at
+the end of the file when the reporter is closed or destructed; a file that
+hasn't been closed can't be read.
+
+All samples in a file must have the same number of q's, u's, and z's; if that
+changes (for example because a Model-stage variable was changed) an exception
+is thrown. Add the reporter to the System with System::addEventReporter(),
+which takes over ownership. **/
+class SimTK_SIMBODY_EXPORT TrajectoryReporter
+:   public PeriodicEventReporter {
+public:
+    /** Create a reporter that writes a sample every \a reportInterval units
+    of time to the file \a fileName, which is created or overwritten. Set
+    \a compress to false to write the raw numbers instead. **/
+    TrajectoryReporter(const System&        system,
+                       const std::string&   fileName,
+                       Real                 reportInterval,
+                       bool                 compress = true);
+
+    /** Closes the file if you haven't already done so. **/
+    ~TrajectoryReporter();
+
+    /** Record the value of this Measure in every sample. The Measure must be
+    evaluable at the Stage the State has been realized to when reported.
+    This must be called before the first sample is written. **/
+    void addMeasure(const Measure& measure);
+
+    /** Set the number of samples written per chunk. Larger chunks compress
+    slightly better; smaller chunks make random access cheaper. The default
+    is 256. This must be called before the first sample is written. **/
+    void setSamplesPerChunk(int n);
+
+    /** Write out any buffered samples and the index, and close the file.
+    Nothing more can be recorded afterwards. **/
+    void close();
+
+    /** Return the number of samples recorded so far. **/
+    int getNumSamples() const;
+
+    /** This is the implementation of the EventReporter virtual. You can
+    also call it yourself to record a sample at any time. **/
+    void handleEvent(const State& state) const override;
+
+    class TrajectoryReporterRep;
+private:
+    TrajectoryReporter(const TrajectoryReporter&) = delete;
+    TrajectoryReporter& operator=(const TrajectoryReporter&) = delete;
+
+    TrajectoryReporterRep* rep;
+    const TrajectoryReporterRep& getRep() const {assert(rep); return *rep;}
+    TrajectoryReporterRep&       updRep() const {assert(rep); return *rep;}
+};
+
+
+
+/** This class reads a file written by TrajectoryReporter. The file is
+memory-mapped rather than read, so opening even a very large file is cheap
+and samples are decoded only when you ask for them. Chunks are decoded as a
+whole and the most recent one is kept, so reading samples in order costs
+about the same as copying them.
+
+A reader is not thread safe; use one per thread. **/
+class SimTK_SIMBODY_EXPORT TrajectoryReader {
+public:
+    /** Open and map the given file. Throws if the file can't be opened or
+    wasn't written (and closed) by a TrajectoryReporter. **/
+    explicit TrajectoryReader(const std::string& fileName);
+    ~TrajectoryReader();
+
+    int getNumSamples()  const;
+    int getNumQ()        const;
+    int getNumU()        const;
+    int getNumZ()        const;
+    int getNumMeasures() const;
+
+    /** Get the time of sample \a i without decoding the rest of it. **/
+    Real getTime(int i) const;
+
+    /** Find the first sample whose time is not less than \a t, or return
+    getNumSamples() if there isn't one. This is a binary search. **/
+    int findSample(Real t) const;
+
+    /** Copy the time, q, u, and z of sample \a i into \a state, which must
+    have been realized through Stage::Model for a System with the same number
+    of each as when the file was recorded. This invalidates Stage::Time and
+    above, so realize the State before using it. **/
+    void fillState(int i, State& state) const;
+
+    /** Get the Measure values recorded in sample \a i, in the order the
+    Measures were added to the reporter. **/
+    void getMeasureValues(int i, Vector& values) const;
+
+    /** Get all the numbers in sample \a i: time, q's, u's, z's, then the
+    Measure values. **/
+    void getSample(int i, Vector& sample) const;
+
+    class TrajectoryReaderRep;
+private:
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+    TrajectoryReaderRep* rep;
+    const TrajectoryReaderRep& getRep() const {assert(rep); return *rep;}
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_TRAJECTORY_REPORTER_H_
@@ -3504,9 +3504,9 @@ convertQForcesToUForces(const State&                          s,
 //               CONVERT BODY ACCEL TO CONSTRAINED BODY ACCEL
 //==============================================================================
 void ConstraintImpl::convertBodyAccelToConstrainedBodyAccel
-   (const State&                                    s,
-    const Array_<SpatialVec, MobilizedBodyIndex>&   allA_GB,
-    Array_<SpatialVec, ConstrainedBodyIndex>&       A_AB) const
+   (const State&                                            s,
+    const ArrayViewConst_<SpatialVec, MobilizedBodyIndex>&  allA_GB,
+    Array_<SpatialVec, ConstrainedBodyIndex>&               A_AB) const
 {
     const SimbodyMatterSubsystemRep& matter = getMyMatterSubsystemRep();
     assert(allA_GB.size() == matter.getNumBodies());
@@ -3556,9 +3556,9 @@ void ConstraintImpl::convertBodyAccelToConstrainedBodyAccel
 //             CONVERT BODY VELOCITY TO CONSTRAINED BODY VELOCITY
 //==============================================================================
 void ConstraintImpl::convertBodyVelocityToConstrainedBodyVelocity
-   (const State&                                    s,
-    const Array_<SpatialVec, MobilizedBodyIndex>&   allV_GB,
-    Array_<SpatialVec, ConstrainedBodyIndex>&       V_AB) const
+   (const State&                                            s,
+    const ArrayViewConst_<SpatialVec, MobilizedBodyIndex>&  allV_GB,
+    Array_<SpatialVec, ConstrainedBodyIndex>&               V_AB) const
 {
     const SimbodyMatterSubsystemRep& matter = getMyMatterSubsystemRep();
     assert(allV_GB.size() == matter.getNumBodies());
@@ -3955,8 +3955,12 @@ calcPositionErrorsFromState(const State& s, Array_<Real>& perr) const {
     const int ncb = getNumConstrainedBodies();
     const int ncq = cInfo.getNumConstrainedQ();
 
-    Array_<Transform, ConstrainedBodyIndex> X_AB(ncb);
-    Array_<Real, ConstrainedQIndex>         cq(ncq);
+    // Use this thread's scratch space to avoid heap allocation.
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().constraintErrorsFromState;
+    Array_<Transform, ConstrainedBodyIndex>& X_AB = scratch.X_AB;
+    Array_<Real, ConstrainedQIndex>&         cq   = scratch.q;
+    X_AB.resize(ncb); cq.resize(ncq);
 
     for (ConstrainedBodyIndex cbx(0); cbx < ncb; ++cbx) 
         X_AB[cbx] = getBodyTransformFromState(s, cbx);
@@ -3985,8 +3989,12 @@ calcPositionDotErrorsFromState(const State& s, Array_<Real>& pverr) const {
     const int ncb = getNumConstrainedBodies();
     const int ncq = cInfo.getNumConstrainedQ();
 
-    Array_<SpatialVec, ConstrainedBodyIndex> V_AB(ncb);
-    Array_<Real, ConstrainedQIndex>          cqdot(ncq);
+    // Use this thread's scratch space to avoid heap allocation.
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().constraintErrorsFromState;
+    Array_<SpatialVec, ConstrainedBodyIndex>& V_AB  = scratch.V_AB;
+    Array_<Real, ConstrainedQIndex>&          cqdot = scratch.q;
+    V_AB.resize(ncb); cqdot.resize(ncq);
 
     for (ConstrainedBodyIndex cbx(0); cbx < ncb; ++cbx) 
         V_AB[cbx] = getBodyVelocityFromState(s, cbx);
@@ -4013,8 +4021,12 @@ calcVelocityErrorsFromState(const State& s, Array_<Real>& verr) const {
     const int ncb = getNumConstrainedBodies();
     const int ncu = cInfo.getNumConstrainedU();
 
-    Array_<SpatialVec, ConstrainedBodyIndex> V_AB(ncb);
-    Array_<Real, ConstrainedUIndex>          cu(ncu);
+    // Use this thread's scratch space to avoid heap allocation.
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().constraintErrorsFromState;
+    Array_<SpatialVec, ConstrainedBodyIndex>& V_AB = scratch.V_AB;
+    Array_<Real, ConstrainedUIndex>&          cu   = scratch.u;
+    V_AB.resize(ncb); cu.resize(ncu);
 
     for (ConstrainedBodyIndex cbx(0); cbx < ncb; ++cbx) 
         V_AB[cbx] = getBodyVelocityFromState(s, cbx);
@@ -153,8 +153,8 @@ void convertQForcesToUForces(const State&                          s,
 // the Ancestor body.
 void convertBodyVelocityToConstrainedBodyVelocity
    (const State&                                    state,
-    const Array_<SpatialVec, MobilizedBodyIndex>&   V_GB,
-    Array_<SpatialVec, ConstrainedBodyIndex>&       V_AB) const;
+    const ArrayViewConst_<SpatialVec, MobilizedBodyIndex>&  V_GB,
+    Array_<SpatialVec, ConstrainedBodyIndex>&               V_AB) const;
 
 // Given a velocity-stage state and an array of body accelerations for all
 // bodies (relative to Ground), select the short list of constrained bodies
@@ -162,8 +162,8 @@ void convertBodyVelocityToConstrainedBodyVelocity
 // the Ancestor body.
 void convertBodyAccelToConstrainedBodyAccel
    (const State&                                    state,
-    const Array_<SpatialVec, MobilizedBodyIndex>&   A_GB,
-    Array_<SpatialVec, ConstrainedBodyIndex>&       A_AB) const;
+    const ArrayViewConst_<SpatialVec, MobilizedBodyIndex>&  A_GB,
+    Array_<SpatialVec, ConstrainedBodyIndex>&               A_AB) const;
 
 void realizeTopology(State&)       const; // eventually calls realizeTopologyVirtual()
 void realizeModel   (State&)       const; // eventually calls realizeModelVirtual() 
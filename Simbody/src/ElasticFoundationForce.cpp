@@ -27,8 +27,10 @@
 #include "simbody/internal/GeneralContactSubsystem.h"
 #include "simbody/internal/MobilizedBody.h"
 #include "ElasticFoundationForceImpl.h"
+#include <algorithm>
 #include <map>
 #include <set>
+#include <utility>
 
 namespace SimTK {
 
@@ -53,6 +55,14 @@ void ElasticFoundationForce::setTransitionVelocity(Real v) {
     updImpl().transitionVelocity = v;
 }
 
+void ElasticFoundationForce::setNumberOfThreads(unsigned numThreads) {
+    updImpl().setNumberOfThreads(numThreads);
+}
+
+int ElasticFoundationForce::getNumberOfThreads() const {
+    return getImpl().getNumberOfThreads();
+}
+
 ElasticFoundationForceImpl::ElasticFoundationForceImpl
    (GeneralContactSubsystem& subsystem, ContactSetIndex set) : 
         subsystem(subsystem), set(set), transitionVelocity(Real(0.01)) {
@@ -89,6 +99,17 @@ void ElasticFoundationForceImpl::setBodyParameters
     subsystem.invalidateSubsystemTopologyCache();
 }
 
+void ElasticFoundationForceImpl::setNumberOfThreads(unsigned numThreads) {
+    SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "ElasticFoundationForceImpl",
+                "setNumberOfThreads", "Number of threads must be positive");
+    if (numThreads == 1) queryExecutor.reset();
+    else queryExecutor = new ParallelExecutor(numThreads);
+}
+
+int ElasticFoundationForceImpl::getNumberOfThreads() const {
+    return queryExecutor.empty() ? 1 : queryExecutor->getMaxThreads();
+}
+
 void ElasticFoundationForceImpl::calcForce
    (const State& state, Vector_<SpatialVec>& bodyForces, 
     Vector_<Vec3>& particleForces, Vector& mobilityForces) const 
@@ -125,6 +146,71 @@ void ElasticFoundationForceImpl::calcForce
     }
 }
 
+// Finds the nearest points for one contiguous chunk of the springs.
+class ElasticFoundationForceImpl::NearestPointsTask 
+:   public ParallelExecutor::Task {
+public:
+    static const int ChunkSize = 64;
+
+    NearestPointsTask(const ContactGeometry& otherObject,
+                      const Array_<Vec3>& positions, Array_<int>& faces, 
+                      Array_<Vec3>& points, Array_<bool>& inside, 
+                      Array_<UnitVec3>& normals)
+    :   otherObject(otherObject), positions(positions), faces(faces),
+        points(points), inside(inside), normals(normals) {}
+
+    void execute(int chunk) override {
+        const unsigned begin = chunk*ChunkSize;
+        const unsigned n = std::min(positions.size()-begin, (unsigned)ChunkSize);
+        findNearestPoints(otherObject, positions(begin, n), faces(begin, n),
+                          points(begin, n), inside(begin, n), 
+                          normals(begin, n));
+    }
+
+    // Use the face guesses if the other object is a mesh, otherwise there is
+    // nothing to guess.
+    static void findNearestPoints(const ContactGeometry& otherObject,
+                                  const ArrayViewConst_<Vec3>& positions,
+                                  ArrayView_<int> faces, ArrayView_<Vec3> points,
+                                  ArrayView_<bool> inside, 
+                                  ArrayView_<UnitVec3> normals) {
+        if (!ContactGeometry::TriangleMesh::isInstance(otherObject)) {
+            otherObject.findNearestPoints(positions, points, inside, normals);
+            return;
+        }
+        const ContactGeometry::TriangleMesh& mesh = 
+            ContactGeometry::TriangleMesh::getAs(otherObject);
+        Array_<Vec2> uvs(positions.size());
+        mesh.findNearestPoints(positions, faces, points, inside, uvs);
+        for (unsigned i = 0; i < positions.size(); ++i)
+            normals[i] = mesh.findNormalAtPoint(faces[i], uvs[i]);
+    }
+private:
+    const ContactGeometry&  otherObject;
+    const Array_<Vec3>&     positions;
+    Array_<int>&            faces;
+    Array_<Vec3>&           points;
+    Array_<bool>&           inside;
+    Array_<UnitVec3>&       normals;
+};
+
+void ElasticFoundationForceImpl::findNearestPoints
+   (const ContactGeometry& otherObject, const Array_<Vec3>& positions,
+    Array_<int>& faces, Array_<Vec3>& points, Array_<bool>& inside, 
+    Array_<UnitVec3>& normals) const 
+{
+    const int chunkSize = NearestPointsTask::ChunkSize;
+    const int numChunks = (positions.size()+chunkSize-1)/chunkSize;
+    NearestPointsTask task(otherObject, positions, faces, points, inside, 
+                           normals);
+    if (!queryExecutor.empty() && numChunks > 1 
+        && !ParallelExecutor::isWorkerThread()) // no nested parallelism
+        queryExecutor->execute(task, numChunks);
+    else
+        NearestPointsTask::findNearestPoints(otherObject, positions, faces, 
+                                             points, inside, normals);
+}
+
 void ElasticFoundationForceImpl::processContact
    (const State& state, 
     ContactSurfaceIndex meshIndex, ContactSurfaceIndex otherBodyIndex, 
@@ -138,20 +224,46 @@ void ElasticFoundationForceImpl::processContact
     const Transform t2g = body2.getBodyTransform(state)*subsystem.getBodyTransform(set, otherBodyIndex); // other object to ground
     const Transform t12 = ~t2g*t1g; // mesh to other object
 
-    // Loop over all the springs, and evaluate the force from each one.
+    // Find the contact point of every spring in one batch, starting from the
+    // faces that were nearest last time. The springs come in face order, 
+    // which keeps neighboring springs mostly together.
+
+    NearestFaceGuesses& allGuesses = Value<NearestFaceGuesses>::updDowncast
+        (subsystem.updCacheEntry(state, guessesCacheIndex));
+    Array_<int>& guesses = allGuesses[std::make_pair(meshIndex, otherBodyIndex)];
+    if (guesses.size() != param.springPosition.size())
+        guesses.assign(param.springPosition.size(), -1);
 
+    const unsigned numSprings = (unsigned)insideFaces.size();
+    Array_<int> springFaces;
+    springFaces.reserve(numSprings);
+    Array_<Vec3> springPositions;
+    springPositions.reserve(numSprings);
+    Array_<int> nearestFaces;
+    nearestFaces.reserve(numSprings);
     for (std::set<int>::const_iterator iter = insideFaces.begin(); 
                                        iter != insideFaces.end(); ++iter) {
-        int face = *iter;
-        UnitVec3 normal;
-        bool inside;
-        Vec3 nearestPoint = otherObject.findNearestPoint(t12*param.springPosition[face], inside, normal);
-        if (!inside)
+        springFaces.push_back(*iter);
+        springPositions.push_back(t12*param.springPosition[*iter]);
+        nearestFaces.push_back(guesses[*iter]);
+    }
+    Array_<Vec3> nearestPoints(numSprings);
+    Array_<bool> springInside(numSprings);
+    Array_<UnitVec3> normals(numSprings);
+    findNearestPoints(otherObject, springPositions, nearestFaces, 
+                      nearestPoints, springInside, normals);
+
+    // Evaluate the force from each spring.
+
+    for (unsigned i = 0; i < numSprings; ++i) {
+        const int face = springFaces[i];
+        guesses[face] = nearestFaces[i];
+        if (!springInside[i])
             continue;
         
         // Find how much the spring is displaced.
         
-        nearestPoint = t2g*nearestPoint;
+        const Vec3 nearestPoint = t2g*nearestPoints[i];
         const Vec3 springPosInGround = t1g*param.springPosition[face];
         const Vec3 displacement = nearestPoint-springPosInGround;
         const Real distance = displacement.norm();
@@ -201,6 +313,8 @@ Real ElasticFoundationForceImpl::calcPotentialEnergy(const State& state) const {
 void ElasticFoundationForceImpl::realizeTopology(State& state) const {
     energyCacheIndex = subsystem.allocateCacheEntry
                         (state, Stage::Dynamics, new Value<Real>());
+    guessesCacheIndex = subsystem.allocateLazyCacheEntry
+                        (state, Stage::Topology, new Value<NearestFaceGuesses>());
 }
 
 
@@ -52,13 +52,36 @@ public:
                         const std::set<int>& insideFaces,
                         Real areaScale,
                         Vector_<SpatialVec>& bodyForces, Real& pe) const;
+    void setNumberOfThreads(unsigned numThreads);
+    int getNumberOfThreads() const;
+
+    // For each (mesh, other surface) pair that has been in contact, the face
+    // of the other surface that was nearest each of the mesh's springs last 
+    // time, or -1. These are only used as starting guesses for the next
+    // nearest point queries, so stale entries cost time but never accuracy.
+    typedef std::map<std::pair<ContactSurfaceIndex, ContactSurfaceIndex>, 
+                     Array_<int> > NearestFaceGuesses;
 private:
+    class NearestPointsTask;
     friend class ElasticFoundationForce;
+
+    // Find the nearest point on the other surface for each spring, splitting
+    // the work among threads if there is enough of it.
+    void findNearestPoints(const ContactGeometry& otherObject,
+                           const Array_<Vec3>& positions,
+                           Array_<int>& faces, Array_<Vec3>& points, 
+                           Array_<bool>& inside, 
+                           Array_<UnitVec3>& normals) const;
+
     const GeneralContactSubsystem& subsystem;
     const ContactSetIndex set;
     std::map<ContactSurfaceIndex, Parameters> parameters;
     Real transitionVelocity;
+    // Null unless more than one thread has been requested. The executor
+    // serializes overlapping calls from different threads itself.
+    mutable ClonePtr<ParallelExecutor> queryExecutor;
     mutable CacheEntryIndex energyCacheIndex;
+    mutable CacheEntryIndex guessesCacheIndex;
 };
 
 class ElasticFoundationForceImpl::Parameters {
@@ -459,6 +459,12 @@ virtual void realizeInstance(
 virtual void realizePosition(
     const SBStateDigest&      sbs) const=0;
 
+// Return true if this node's realizePosition() leaves the joint-independent
+// kinematics (see calcJointIndependentKinematicsPos()) to be calculated
+// separately, for many bodies at once, when the tree position cache says
+// they are being batched.
+virtual bool canBatchJointIndependentKinematicsPos() const {return false;}
+
 // Introduce new values for generalized speeds and calculate
 // all the velocity-dependent kinematic terms. Assumes realizePosition()
 // has already been called on all nodes. Must be called base to tip.
@@ -283,10 +283,13 @@ void realizePosition(const SBStateDigest& sbs) const override
     // Ground. (F is fixed on P and M is fixed on B.)
     calcParentToChildVelocityJacobianInGround(mv,pc, updH(pc));
 
-    // Mobilizer independent.
-    calcJointIndependentKinematicsPos(pc);
+    // Mobilizer independent. This may be done later for many bodies at once.
+    if (!pc.jointIndependentKinematicsBatched)
+        calcJointIndependentKinematicsPos(pc);
 }
 
+bool canBatchJointIndependentKinematicsPos() const override {return true;}
+
 // Set new velocities for the current configuration, and calculate
 // all the velocity-dependent terms. Must call base-to-tip.
 // This routine may assume that *all* position 
@@ -107,6 +107,22 @@ void SimbodyMatterSubsystem::setShowDefaultGeometry(bool show) {
     updRep().setShowDefaultGeometry(show);
 }
 
+void SimbodyMatterSubsystem::setNumberOfThreads(unsigned numThreads) {
+    updRep().setNumberOfThreads(numThreads);
+}
+
+int SimbodyMatterSubsystem::getNumberOfThreads() const {
+    return getRep().getNumberOfThreads();
+}
+
+void SimbodyMatterSubsystem::setParallelLevelCostThreshold(Real flops) {
+    updRep().setParallelLevelCostThreshold(flops);
+}
+
+Real SimbodyMatterSubsystem::getParallelLevelCostThreshold() const {
+    return getRep().getParallelLevelCostThreshold();
+}
+
 
 ConstraintIndex SimbodyMatterSubsystem::
 adoptConstraint(Constraint& child) {return updRep().adoptConstraint(child);}
@@ -395,6 +411,12 @@ void SimbodyMatterSubsystem::multiplyByM(const State&  state,
     Ma.resize(nu);
     if (nu==0) return;
 
+    // Usual case: no copying, and no temporaries to construct.
+    if (a.hasContiguousData() && Ma.hasContiguousData()) {
+        rep.multiplyByM(state, a, Ma);
+        return;
+    }
+
     // Assume at first that both Vectors are contiguous.
     const Vector* ca    = &a;
     Vector*       cMa   = &Ma;
@@ -444,6 +466,12 @@ void SimbodyMatterSubsystem::multiplyByMInv(const State&    state,
     MInvV.resize(nu);
     if (nu==0) return;
 
+    // Usual case: no copying, and no temporaries to construct.
+    if (v.hasContiguousData() && MInvV.hasContiguousData()) {
+        rep.multiplyByMInv(state, v, MInvV);
+        return;
+    }
+
     // Assume at first that both Vectors are contiguous.
     const Vector* cv    = &v;
     Vector*       cMInvV   = &MInvV;
@@ -25,6 +25,7 @@
 
 #include "SimTKcommon.h"
 #include "SimTKmath.h"
+#include "SimTKlapack.h"
 #include "simbody/internal/common.h"
 #include "simbody/internal/ConditionalConstraint.h"
 
@@ -37,6 +38,9 @@
 
 #include <string>
 #include <iostream>
+#include <exception>
+#include <memory>
+#include <vector>
 using std::cout; using std::endl;
 
 SimbodyMatterSubsystemRep::SimbodyMatterSubsystemRep
@@ -47,6 +51,104 @@ SimbodyMatterSubsystemRep::SimbodyMatterSubsystemRep
 }
 
 
+
+//==============================================================================
+//                            SCRATCH CACHE LEASE
+//==============================================================================
+namespace {
+// Each thread's SBScratchCache objects, created as needed and deleted when the
+// thread exits. The first numLeasedScratchCaches of them are in use.
+thread_local std::vector<std::unique_ptr<SBScratchCache>> scratchCachePool;
+thread_local unsigned numLeasedScratchCaches = 0;
+}
+
+SBScratchCacheLease::SBScratchCacheLease() {
+    if (numLeasedScratchCaches == scratchCachePool.size())
+        scratchCachePool.emplace_back(new SBScratchCache());
+    scratch = scratchCachePool[numLeasedScratchCaches++].get();
+}
+
+SBScratchCacheLease::~SBScratchCacheLease() {
+    assert(numLeasedScratchCaches > 0 
+           && scratchCachePool[numLeasedScratchCaches-1].get() == scratch);
+    --numLeasedScratchCaches;
+}
+
+
+
+//==============================================================================
+//                        LEVEL-PARALLEL TREE SWEEPS
+//==============================================================================
+namespace {
+// Applies a per-node operation to each of the nodes of one tree level. The
+// ParallelExecutor reports and then swallows exceptions thrown on its worker
+// threads, so we hold on to the first one here and rethrow it on the calling
+// thread once the whole level is done.
+template <class NodeOp>
+class ProcessLevelTask : public ParallelExecutor::Task {
+public:
+    ProcessLevelTask(const RBNodePtrList& nodes, const NodeOp& op)
+    :   m_nodes(nodes), m_op(op) {}
+
+    void execute(int j) override {
+        try {
+            m_op(*m_nodes[j]);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_errorLock);
+            if (!m_error) m_error = std::current_exception();
+        }
+    }
+
+    void rethrowIfFailed() const 
+    {   if (m_error) std::rethrow_exception(m_error); }
+private:
+    const RBNodePtrList&    m_nodes;
+    const NodeOp&           m_op;
+    std::mutex              m_errorLock;
+    std::exception_ptr      m_error;
+};
+}
+
+bool SimbodyMatterSubsystemRep::
+shouldProcessLevelInParallel(int level, TreeSweepCost cost) const {
+    return hasTreeSweepExecutor.load(std::memory_order_relaxed)
+        && rbNodeLevels[level].size() > 1
+        && rbNodeLevelCost[cost][level] >= parallelLevelCostThreshold
+        && !ParallelExecutor::isWorkerThread(); // no nested parallelism
+}
+
+template <class NodeOp> void SimbodyMatterSubsystemRep::
+processLevel(int level, TreeSweepCost cost, const NodeOp& op) const {
+    const RBNodePtrList& nodes = rbNodeLevels[level];
+    if (shouldProcessLevelInParallel(level, cost)) {
+        std::unique_lock<std::mutex> 
+            lock(treeSweepExecutorLock, std::try_to_lock);
+        // The executor may have been removed since we checked the flag.
+        if (lock.owns_lock() && !treeSweepExecutor.empty()) {
+            ProcessLevelTask<NodeOp> task(nodes, op);
+            treeSweepExecutor->execute(task, (int)nodes.size());
+            task.rethrowIfFailed();
+            return;
+        }
+        // Someone else is using the executor; fall through to serial.
+    }
+    for (int j=0; j < (int)nodes.size(); ++j)
+        op(*nodes[j]);
+}
+
+template <class NodeOp> void SimbodyMatterSubsystemRep::
+sweepBaseToTip(TreeSweepCost cost, const NodeOp& op) const {
+    for (int i=0; i < (int)rbNodeLevels.size(); ++i)
+        processLevel(i, cost, op);
+}
+
+template <class NodeOp> void SimbodyMatterSubsystemRep::
+sweepTipToBase(TreeSweepCost cost, const NodeOp& op) const {
+    for (int i=(int)rbNodeLevels.size()-1; i >= 0; --i)
+        processLevel(i, cost, op);
+}
+
+
 void SimbodyMatterSubsystemRep::clearTopologyState() {
     // Unilateral constraints reference Constraints but not vice versa,
     // so delete the conditional constraints first.
@@ -102,6 +204,11 @@ void SimbodyMatterSubsystemRep::clearTopologyCache() {
     // be deleted when the MobilizedBodyImpl objects are.
     rbNodeLevels.clear();
     nodeNum2NodeMap.clear();
+    for (int k=0; k < NumTreeSweepCosts; ++k)
+        rbNodeLevelCost[k].clear();
+    soaKinematicsNodes.clear(); soaMass.clear();
+    for (int i=0; i < 3; ++i) soaCOM_B[i].clear();
+    for (int i=0; i < 6; ++i) soaG_Bo_B[i].clear();
 
     showDefaultGeometry = true;
 }
@@ -264,6 +371,11 @@ void SimbodyMatterSubsystemRep::endConstruction(State& s) {
     // objects rather than on MobilizedBody objects.
     nodeNum2NodeMap.clear();
     rbNodeLevels.clear();
+    for (int k=0; k < NumTreeSweepCosts; ++k)
+        rbNodeLevelCost[k].clear();
+    soaKinematicsNodes.clear(); soaMass.clear();
+    for (int i=0; i < 3; ++i) soaCOM_B[i].clear();
+    for (int i=0; i < 6; ++i) soaG_Bo_B[i].clear();
     DOFTotal = SqDOFTotal = maxNQTotal = 0;
 
     // state allocation
@@ -288,8 +400,30 @@ void SimbodyMatterSubsystemRep::endConstruction(State& s) {
 
         // Count up multibody tree totals.
         const int ndof = n.getDOF();
+
+        // Estimate this node's share of the work in each kind of sweep. The
+        // expensive one is the articulated body inertia flop count from
+        // RigidBodyNodeSpec (pin=143, ball=591, free=1746); the cheap one is
+        // typical of the O(dof) operator passes like multiplyByMInv().
+        for (int k=0; k < NumTreeSweepCosts; ++k)
+            if ((int)rbNodeLevelCost[k].size() <= level)
+                rbNodeLevelCost[k].resize(level+1, Real(0));
+        rbNodeLevelCost[ExpensiveSweep][level] += 
+            ndof*ndof*ndof + 23*ndof*ndof + 115*ndof + 12;
+        rbNodeLevelCost[CheapSweep][level] += 30*ndof + 30;
         DOFTotal += ndof; SqDOFTotal += ndof*ndof;
         maxNQTotal += n.getMaxNQ();
+
+        if (n.canBatchJointIndependentKinematicsPos()) {
+            soaKinematicsNodes.push_back(&n);
+            soaMass.push_back(n.getMass());
+            const Vec3& com = n.getCOM_B();
+            for (int i=0; i < 3; ++i) soaCOM_B[i].push_back(com[i]);
+            const UnitInertia& G = n.getUnitInertia_OB_B();
+            const Vec3& m = G.getMoments(); const Vec3& p = G.getProducts();
+            for (int i=0; i < 3; ++i) {soaG_Bo_B[i].push_back(m[i]);
+                                       soaG_Bo_B[3+i].push_back(p[i]);}
+        }
     }
     
     // Order doesn't matter for constraints as long as the bodies are already 
@@ -477,6 +611,22 @@ int SimbodyMatterSubsystemRep::realizeSubsystemTopologyImpl(State& s) const {
         allocateLazyCacheEntry(s, Stage::Dynamics,
                                new Value<SBConstrainedAccelerationCache>());
 
+    // Factors of the diagonal blocks of G M^-1 ~G. These deliberately depend
+    // only on Instance stage so that they can be reused (as a very good 
+    // initial guess) after t, q, or u change; see solveProjectedMInv().
+    tc.projectedMInvFactorCacheIndex = s.allocateCacheEntryWithPrerequisites
+       (getMySubsystemIndex(), Stage::Instance, Stage::Infinity,
+        false /*q*/, false /*u*/, false /*z*/, {} /*dv*/, {} /*ce*/,
+        new Value<SBProjectedMInvFactorCache>());
+
+    // Workspace for the batched joint-independent position kinematics, only
+    // if that has been requested. Otherwise no State pays for it.
+    tc.soaKinematicsCacheIndex.invalidate();
+    if (useStructureOfArraysKinematics && !soaKinematicsNodes.empty())
+        tc.soaKinematicsCacheIndex = 
+            allocateLazyCacheEntry(s, Stage::Topology,
+                                   new Value<SBTreePositionSoA>());
+
     tc.valid = true;
 
     // Allocate a cache entry for the topologyCache, and save a copy there.
@@ -968,6 +1118,10 @@ realizeSubsystemInstanceImpl(const State& s) const {
     for (ConstraintIndex cx(0); cx < constraints.size(); ++cx)
         getConstraint(cx).getImpl().realizeInstance(s);
 
+    // Now that we know which constraint equations are in use, find the ones
+    // that are dynamically coupled.
+    findDynamicallyCoupledMultipliers(s, ic);
+
 
     // Quaternion errors are located after last holonomic constraint error; 
     // see diagram above.
@@ -1130,9 +1284,15 @@ realizePositionKinematics(const State& state) const {
     // Any body which is using quaternions should calculate the quaternion
     // constraint here and put it in the appropriate slot of qErr.
     // Set generalized coordinates: sweep from base to tips.
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++)
-            rbNodeLevels[i][j]->realizePosition(stateDigest); 
+    tpc.jointIndependentKinematicsBatched = 
+        topologyCache.soaKinematicsCacheIndex.isValid();
+    sweepBaseToTip(ExpensiveSweep, [&](const RigidBodyNode& node)
+    {   node.realizePosition(stateDigest); });
+
+    // If the nodes skipped their joint-independent kinematics, do it now for
+    // all of them at once.
+    if (tpc.jointIndependentKinematicsBatched)
+        calcJointIndependentKinematicsPosBatched(state, tpc);
 
     // Ask the constraints to calculate ancestor-relative kinematics (still 
     // goes in TreePositionCache).
@@ -1143,6 +1303,113 @@ realizePositionKinematics(const State& state) const {
     markCacheValueRealized(state, tpcx);
 }
 
+//==============================================================================
+//            CALC JOINT INDEPENDENT KINEMATICS POS -- BATCHED
+//==============================================================================
+// This does the same calculation as 
+// RigidBodyNode::calcJointIndependentKinematicsPos() but for all the batchable
+// nodes at once. We gather the transforms into structure-of-arrays form, do 
+// the arithmetic in simple loops over the bodies (each of which the compiler
+// can vectorize since there are no dependencies from one body to the next),
+// then scatter the results back into the tree position cache. The transforms
+// must already have been calculated by the base-to-tip sweep.
+void SimbodyMatterSubsystemRep::
+calcJointIndependentKinematicsPosBatched(const State& state,
+                                         SBTreePositionCache& pc) const {
+    const int n = (int)soaKinematicsNodes.size();
+    SBTreePositionSoA& soa = Value<SBTreePositionSoA>::updDowncast
+        (state.updCacheEntry(getMySubsystemIndex(),
+                             topologyCache.soaKinematicsCacheIndex)).upd();
+    soa.resize(n);
+
+    // Gather.
+    for (int b=0; b < n; ++b) {
+        const RigidBodyNode& node = *soaKinematicsNodes[b];
+        const MobilizedBodyIndex mbx = node.getNodeNum();
+        const MobilizedBodyIndex px = node.getParent()->getNodeNum();
+        const Rotation& R_GP = pc.bodyConfigInGround[px].R();
+        const Transform& X_PB = pc.bodyConfigInParent[mbx];
+        const Transform& X_GB = pc.bodyConfigInGround[mbx];
+        for (int i=0; i < 3; ++i) {
+            for (int j=0; j < 3; ++j) {
+                soa.R_GP[3*i+j][b] = R_GP.asMat33()(i,j);
+                soa.R_GB[3*i+j][b] = X_GB.R().asMat33()(i,j);
+            }
+            soa.p_PB[i][b] = X_PB.p()[i];
+            soa.p_GB[i][b] = X_GB.p()[i];
+        }
+    }
+
+    // Re-express parent-to-child shift vector into Ground, and find the
+    // mass center location (15+15+3 flops per body).
+    for (int i=0; i < 3; ++i) {
+        const Real* Rp0 = soa.R_GP[3*i].cbegin();
+        const Real* Rp1 = soa.R_GP[3*i+1].cbegin();
+        const Real* Rp2 = soa.R_GP[3*i+2].cbegin();
+        const Real* Rb0 = soa.R_GB[3*i].cbegin();
+        const Real* Rb1 = soa.R_GB[3*i+1].cbegin();
+        const Real* Rb2 = soa.R_GB[3*i+2].cbegin();
+        const Real* p0 = soa.p_PB[0].cbegin();
+        const Real* p1 = soa.p_PB[1].cbegin();
+        const Real* p2 = soa.p_PB[2].cbegin();
+        const Real* c0 = soaCOM_B[0].cbegin();
+        const Real* c1 = soaCOM_B[1].cbegin();
+        const Real* c2 = soaCOM_B[2].cbegin();
+        const Real* pGB = soa.p_GB[i].cbegin();
+        Real* pPBG = soa.p_PB_G[i].begin();
+        Real* pBBcG = soa.p_BBc_G[i].begin();
+        Real* pGBc = soa.p_GBc[i].begin();
+        for (int b=0; b < n; ++b) {
+            pPBG[b]  = Rp0[b]*p0[b] + Rp1[b]*p1[b] + Rp2[b]*p2[b];
+            pBBcG[b] = Rb0[b]*c0[b] + Rb1[b]*c1[b] + Rb2[b]*c2[b];
+            pGBc[b]  = pGB[b] + pBBcG[b];
+        }
+    }
+
+    // Re-express the unit inertia in Ground: G_Bo_G = R_GB G_Bo_B ~R_GB. We
+    // form T = R_GB G_Bo_B then compute only the six unique elements of
+    // T ~R_GB.
+    const Real* Gxx = soaG_Bo_B[0].cbegin(); 
+    const Real* Gyy = soaG_Bo_B[1].cbegin();
+    const Real* Gzz = soaG_Bo_B[2].cbegin(); 
+    const Real* Gxy = soaG_Bo_B[3].cbegin();
+    const Real* Gxz = soaG_Bo_B[4].cbegin(); 
+    const Real* Gyz = soaG_Bo_B[5].cbegin();
+    static const int row[6] = {0,1,2,1,2,2}, col[6] = {0,1,2,0,0,1};
+    for (int e=0; e < 6; ++e) {
+        const int i = row[e], j = col[e];
+        const Real* Ri0 = soa.R_GB[3*i].cbegin();
+        const Real* Ri1 = soa.R_GB[3*i+1].cbegin();
+        const Real* Ri2 = soa.R_GB[3*i+2].cbegin();
+        const Real* Rj0 = soa.R_GB[3*j].cbegin();
+        const Real* Rj1 = soa.R_GB[3*j+1].cbegin();
+        const Real* Rj2 = soa.R_GB[3*j+2].cbegin();
+        Real* out = soa.G_Bo_G[e].begin();
+        for (int b=0; b < n; ++b) {
+            const Real t0 = Ri0[b]*Gxx[b] + Ri1[b]*Gxy[b] + Ri2[b]*Gxz[b];
+            const Real t1 = Ri0[b]*Gxy[b] + Ri1[b]*Gyy[b] + Ri2[b]*Gyz[b];
+            const Real t2 = Ri0[b]*Gxz[b] + Ri1[b]*Gyz[b] + Ri2[b]*Gzz[b];
+            out[b] = t0*Rj0[b] + t1*Rj1[b] + t2*Rj2[b];
+        }
+    }
+
+    // Scatter.
+    for (int b=0; b < n; ++b) {
+        const MobilizedBodyIndex mbx = soaKinematicsNodes[b]->getNodeNum();
+        pc.bodyToParentShift[mbx] = PhiMatrix(Vec3(soa.p_PB_G[0][b],
+                                                   soa.p_PB_G[1][b],
+                                                   soa.p_PB_G[2][b]));
+        pc.bodyCOMInGround[mbx] = Vec3(soa.p_GBc[0][b], soa.p_GBc[1][b],
+                                       soa.p_GBc[2][b]);
+        const UnitInertia G_Bo_G
+           (Vec3(soa.G_Bo_G[0][b], soa.G_Bo_G[1][b], soa.G_Bo_G[2][b]),
+            Vec3(soa.G_Bo_G[3][b], soa.G_Bo_G[4][b], soa.G_Bo_G[5][b]));
+        pc.bodySpatialInertiaInGround[mbx] = SpatialInertia(soaMass[b],
+            Vec3(soa.p_BBc_G[0][b], soa.p_BBc_G[1][b], soa.p_BBc_G[2][b]),
+            G_Bo_G);
+    }
+}
+
 // Position kinematics is realized only if 
 //  - we are currently at Stage::Position or later
 //      OR
@@ -1238,9 +1505,8 @@ realizeArticulatedBodyInertias(const State& state) const {
     SBArticulatedBodyInertiaCache&  abc = updArticulatedBodyInertiaCache(state);
 
     // tip-to-base sweep
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; --i) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; ++j)
-            rbNodeLevels[i][j]->realizeArticulatedBodyInertiasInward(ic,tpc,abc);
+    sweepTipToBase(ExpensiveSweep, [&](const RigidBodyNode& node)
+    {   node.realizeArticulatedBodyInertiasInward(ic,tpc,abc); });
 
     markCacheValueRealized(state, abx);
 }
@@ -2248,8 +2514,13 @@ calcConstraintForcesFromMultipliers
     bodyForcesInG.resize(getNumBodies()); bodyForcesInG.setToZero();
     mobilityForces.resize(getNU(s));      mobilityForces.setToZero();
 
-    // These Arrays are for one constraint at a time.
-    Array_<Real> lambdap, lambdav, lambdaa; // multipliers
+    // These Arrays are for one constraint at a time. They are kept in the
+    // State's scratch cache to avoid heap allocation.
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().calcConstraintForcesFromMultipliers;
+    Array_<Real>& lambdap = scratch.lambdap; // multipliers
+    Array_<Real>& lambdav = scratch.lambdav;
+    Array_<Real>& lambdaa = scratch.lambdaa;
 
     // Loop over all enabled constraints, ask them to generate forces, and
     // accumulate the results in the global problem return vectors.
@@ -2389,11 +2660,14 @@ multiplyByPVATranspose( const State&     s,
     if (nu==0) return;
     if (m==0) {allfuVector.setToZero(); return;}
 
-    // Allocate a temporary body forces vector here. We'll map these to 
+    // Get a temporary body forces vector here. We'll map these to 
     // generalized forces as the penultimate step, then add those into 
     // the output argument allfuVector which will have already accumulated 
     // all directly-generated mobility forces.
-    Vector_<SpatialVec> allF_GVector(nb);
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().multiplyByPVATranspose;
+    Vector_<SpatialVec>& allF_GVector = scratch.allF_G;
+    allF_GVector.resize(nb);
 
     // We'll be accumulating constraint forces into these Vectors so zero 
     // them now. Multiple constraints may contribute to forces on the same 
@@ -2416,13 +2690,13 @@ multiplyByPVATranspose( const State&     s,
     // These Arrays are for one constraint at a time. We need separate 
     // memory for these because constrained bodies and constrained u's are
     // not ordered the same as the global ones, nor are they necessarily
-    // contiguous in the global arrays. We're declaring these arrays
-    // outside the loop to avoid heap allocation -- they will grow to the
+    // contiguous in the global arrays. These arrays are kept in the State's
+    // scratch cache to avoid heap allocation -- they will grow to the
     // max size needed by any constraint, then get resized as needed without
     // further heap allocation.
-    Array_<SpatialVec,ConstrainedBodyIndex> oneF_G; // body spatial forces
-    Array_<Real,      ConstrainedUIndex>    onefu;  // u-space generalized forces     
-    Array_<Real,      ConstrainedQIndex>    onefq;  // q-space generalized forces     
+    Array_<SpatialVec,ConstrainedBodyIndex>& oneF_G = scratch.oneF_G; // body spatial forces
+    Array_<Real,      ConstrainedUIndex>&    onefu  = scratch.onefu;  // u-space generalized forces
+    Array_<Real,      ConstrainedQIndex>&    onefq  = scratch.onefq;  // q-space generalized forces
 
     // Loop over all enabled constraints, ask them to generate forces, and
     // accumulate the results in the global problem arrays (allF_G,allfu).
@@ -2496,7 +2770,7 @@ multiplyByPVATranspose( const State&     s,
 
     // Map the body forces into u-space generalized forces.
     // 12*nu + 18*nb flops.
-    Vector ftmp(nu);
+    Vector& ftmp = scratch.ftmp;
     multiplyBySystemJacobianTranspose(s, allF_GVector, ftmp);
     allfuVector += ftmp;
 }
@@ -2822,19 +3096,21 @@ calcBiasForMultiplyByPVA(const State& s,
 
     // This array will be resized and filled with the Ancestor-relative
     // coriolis accelerations for the constrained bodies of each velocity
-    // or acceleration-only Constraint in turn; we're declaring it outside the 
-    // loop to minimize heap allocation (resizing down doesn't normally free 
+    // or acceleration-only Constraint in turn; it lives in the State's scratch
+    // cache to avoid heap allocation (resizing down doesn't normally free 
     // heap space). This won't be used if we have only holonomic constraints.
-    Array_<SpatialVec,ConstrainedBodyIndex> AC_AB;
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().calcBiasForMultiplyByPVA;
+    Array_<SpatialVec,ConstrainedBodyIndex>& AC_AB = scratch.AC_AB;
 
     // Subarrays of these all-zero arrays will be used to supply zero body
     // velocities and qdots (holonomic) or zero udots (nonholonomic and
-    // acceleration-only) for each Constraint in turn; we're declaring 
-    // them outside the loop to minimize heap allocation. They'll grow until 
-    // they hit the maximum size needed by any Constraint.
-    Array_<SpatialVec,ConstrainedBodyIndex> zeroV_AB;
-    Array_<Real,      ConstrainedQIndex>    zeroQDot;
-    Array_<Real,      ConstrainedUIndex>    zeroUDot;
+    // acceleration-only) for each Constraint in turn; they also live in the
+    // scratch cache and are never written except to grow them. They'll grow
+    // until they hit the maximum size needed by any Constraint.
+    Array_<SpatialVec,ConstrainedBodyIndex>& zeroV_AB = scratch.zeroV_AB;
+    Array_<Real,      ConstrainedQIndex>&    zeroQDot = scratch.zeroQDot;
+    Array_<Real,      ConstrainedUIndex>&    zeroUDot = scratch.zeroUDot;
 
     // Loop over all enabled constraints, ask them to generate constraint
     // errors, and collect those in the output bias vector.
@@ -3284,8 +3560,11 @@ multiplyByPVA(  const State&     s,
     // Generate body spatial velocities V=J*u or first term of the
     // body spatial accelerations A=J*udot + Jdot*u, depending on how we're
     // interpreting the ulike argument (as a u for holonomic constraints,
-    // and as udot for everything else).
-    Vector_<SpatialVec> Julike(nb);
+    // and as udot for everything else). Temporaries come from the State's
+    // scratch cache.
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().multiplyByPVA;
+    Vector_<SpatialVec>& Julike = scratch.Julike;
     multiplyBySystemJacobian(s, ulike, Julike); // 12*(nu+nb) flops
 
     // Julike serves as V_GB when we're interpreting ulike as u.
@@ -3294,10 +3573,10 @@ multiplyByPVA(  const State&     s,
 
     // If we're doing any nonholonomic or acceleration-only constraints, we'll 
     // finish calculating body spatial accelerations and put them here.
-    Array_<SpatialVec,MobilizedBodyIndex> allA_GB;
+    Array_<SpatialVec,MobilizedBodyIndex>& allA_GB = scratch.allA_GB;
     if (mNonholo || mAccOnly) {
         allA_GB.resize(nb);
-        const Array_<SpatialVec>& 
+        const Array_<SpatialVec,MobilizedBodyIndex>& 
             allAC_GB = getTreeVelocityCache(s).totalCoriolisAcceleration;
         for (MobilizedBodyIndex b(0); b < nb; ++b)
             allA_GB[b] = allV_GB[b] + allAC_GB[b]; // i.e., J*udot + Jdot*u
@@ -3306,7 +3585,8 @@ multiplyByPVA(  const State&     s,
     // If we're going to be dealing with holonomic (position) constraints,
     // generate a q-like Vector via qlike = N * ulike since the position
     // error derivative routine wants qdots.
-    Vector qlike(nq);
+    Vector& qlike = scratch.qlike;
+    qlike.resize(nq);
     if (mHolo)
         multiplyByN(s, false, ulike, qlike);   // cheap
 
@@ -3319,20 +3599,20 @@ multiplyByPVA(  const State&     s,
 
     // This array will be resized and filled with the Ancestor-relative
     // velocities for the constrained bodies of each holonomic Constraint in 
-    // turn; we're declaring it outside the loop to minimize heap allocation 
+    // turn; it is in the scratch cache to avoid heap allocation 
     // (resizing down doesn't normally free heap space). This won't be used 
     // if we aren't processing holonomic constraints.
-    Array_<SpatialVec,ConstrainedBodyIndex> V_AB;
+    Array_<SpatialVec,ConstrainedBodyIndex>& V_AB = scratch.V_AB;
     // Same, but for each holonomic constraint's qdot subset.
-    Array_<Real,ConstrainedQIndex> qdot;
+    Array_<Real,ConstrainedQIndex>& qdot = scratch.qdot;
 
     // This array will be resized and filled with the Ancestor-relative
     // accelerations for the constrained bodies of each velocity
     // or acceleration-only Constraint in turn. This won't be used if we have 
     // only holonomic constraints.
-    Array_<SpatialVec,ConstrainedBodyIndex> A_AB;
+    Array_<SpatialVec,ConstrainedBodyIndex>& A_AB = scratch.A_AB;
     // Same, but for each nonholonomic/acconly constraint's udot subset.
-    Array_<Real,ConstrainedUIndex> udot;
+    Array_<Real,ConstrainedUIndex>& udot = scratch.udot;
 
     // Loop over all enabled constraints, ask them to generate constraint
     // errors, and collect those in the output argument PVAu. Remove bias
@@ -3520,42 +3800,409 @@ calcGMInvGt(const State&   s,
     const int mNonholo = ic.totalNNonholonomicConstraintEquationsInUse;
     const int mAccOnly = ic.totalNAccelerationOnlyConstraintEquationsInUse;
     const int m        = mHolo+mNonholo+mAccOnly;  
-    const int nu       = getNU(s);
 
     GMInvGt.resize(m,m);
     if (m==0) return;
 
-    // If the output matrix doesn't have columns in contiguous memory, we'll
-    // allocate a contiguous-memory temp that we can use to hold one column
-    // at a time as we compute them.
-    const bool columnsAreContiguous = GMInvGt(0).hasContiguousData();
-    Vector GMInvGt_j(columnsAreContiguous ? 0 : m);
+    // Only the diagonal blocks of dynamically coupled multipliers can be
+    // nonzero; calculate those and scatter them into the result.
+    Array_<Matrix> blocks;
+    calcGMInvGtBlocks(s, Array_<bool>(ic.dynamicallyCoupledMultipliers.size(),
+                                      true), blocks);
+
+    GMInvGt.setToZero();
+    for (unsigned b=0; b < blocks.size(); ++b) {
+        const Array_<MultiplierIndex>& mults = 
+            ic.dynamicallyCoupledMultipliers[b];
+        for (unsigned j=0; j < mults.size(); ++j)
+            for (unsigned i=0; i < mults.size(); ++i)
+                GMInvGt(mults[i], mults[j]) = blocks[b](i,j);
+    }
+} 
+
+
+
+// =============================================================================
+//                          CALC G MInv G^T BLOCKS
+// =============================================================================
+// Each column of G M^-1 ~G is obtained as above with an O(n) operator 
+// sequence applied to a unit multiplier-like vector. But if we put a 1 in
+// the same column position of *every* group of dynamically coupled 
+// multipliers at once, the results don't interfere: the forces produced by
+// one group's multiplier can only accelerate that group's subtrees, and only 
+// that group's constraint equations can see those accelerations. So with k
+// the size of the largest group we need only k operator sequences rather
+// than m. Here k is the size of the largest group that was asked for; the
+// other groups' blocks are returned empty.
+//
+// Complexity is O(k*(m+n)) plus O(sum(mb^2)) to unpack the blocks.
+void SimbodyMatterSubsystemRep::
+calcGMInvGtBlocks(const State&          s,
+                  const Array_<bool>&   which,
+                  Array_<Matrix>&       blocks) const
+{
+    const SBInstanceCache& ic = getInstanceCache(s);
+    const Array_< Array_<MultiplierIndex> >& groups = 
+        ic.dynamicallyCoupledMultipliers;
+
+    const int m  = ic.totalNHolonomicConstraintEquationsInUse
+                 + ic.totalNNonholonomicConstraintEquationsInUse
+                 + ic.totalNAccelerationOnlyConstraintEquationsInUse;
+    const int nu = getNU(s);
+
+    assert(which.size() == groups.size());
+    blocks.resize(groups.size());
+    int maxGroupSize = 0;
+    for (unsigned b=0; b < groups.size(); ++b) {
+        const int mb = which[b] ? (int)groups[b].size() : 0;
+        blocks[b].resize(mb, mb);
+        maxGroupSize = std::max(maxGroupSize, mb);
+    }
+    if (m==0 || maxGroupSize==0) return;
 
-    // These two temporaries are always needed to hold one column of Gt,
-    // then one column of M^-1 * Gt.
-    Vector Gtcol(nu), MInvGtcol(nu);
+    // These temporaries hold one (combined) column of Gt, then M^-1 * Gt,
+    // then G M^-1 ~G. They come from the State's scratch cache.
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().calcGMInvGtBlocks;
+    Vector& Gtcol      = scratch.Gtcol;
+    Vector& MInvGtcol  = scratch.MInvGtcol;
+    Vector& GMInvGtcol = scratch.GMInvGtcol;
 
     // Precalculate bias so we can perform multiplication by G efficiently.
-    Vector bias(m);
+    Vector& bias = scratch.bias;
     calcBiasForMultiplyByPVA(s,true,true,true,bias);
-   
-    // Lambda is used to pluck out one column at a time of Gt. Exactly one
-    // element at a time of lambda will be 1, the rest are 0.
-    Vector lambda(m, Real(0));
 
-    for (int j=0; j < m; ++j) {
-        lambda[j] = 1;
+    Vector& lambda = scratch.lambda;
+    lambda.resize(m); lambda.setToZero();
+    for (int k=0; k < maxGroupSize; ++k) {
+        for (unsigned b=0; b < groups.size(); ++b)
+            if (k < blocks[b].nrow()) lambda[groups[b][k]] = 1;
+
         multiplyByPVATranspose(s, true, true, true, lambda, Gtcol);
-        lambda[j] = 0;
         multiplyByMInv(s, Gtcol, MInvGtcol);
-        if (columnsAreContiguous)
-            multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGt(j));
-        else {
-            multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGt_j);
-            GMInvGt(j) = GMInvGt_j;
+        multiplyByPVA(s, true, true, true, bias, MInvGtcol, GMInvGtcol);
+
+        for (unsigned b=0; b < groups.size(); ++b) {
+            const Array_<MultiplierIndex>& mults = groups[b];
+            if (k >= blocks[b].nrow()) continue;
+            lambda[mults[k]] = 0;
+            for (unsigned i=0; i < mults.size(); ++i)
+                blocks[b](i,k) = GMInvGtcol[mults[i]];
         }
     }
-} 
+}
+
+
+
+// =============================================================================
+//                          MULTIPLY BY G MInv G^T
+// =============================================================================
+// Complexity is O(m+n).
+void SimbodyMatterSubsystemRep::
+multiplyByGMInvGt(const State&  s,
+                  const Vector& bias,
+                  const Vector& x,
+                  Vector&       GMInvGtx) const
+{
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().multiplyByGMInvGt;
+    Vector& Gtx     = scratch.Gtx;
+    Vector& MInvGtx = scratch.MInvGtx;
+    multiplyByPVATranspose(s, true, true, true, x, Gtx);
+    multiplyByMInv(s, Gtx, MInvGtx);
+    multiplyByPVA(s, true, true, true, bias, MInvGtx, GMInvGtx);
+}
+
+
+
+// =============================================================================
+//                         SOLVE PROJECTED M INVERSE
+// =============================================================================
+namespace {
+// Gather the entries of a multiplier-like vector belonging to one group.
+void gatherGroup(const Array_<MultiplierIndex>& mults, const Vector& in,
+                 Vector& out) {
+    out.resize(mults.size());
+    for (unsigned i=0; i < mults.size(); ++i) out[i] = in[mults[i]];
+}
+
+// Scatter a group's entries back into a multiplier-like vector.
+void scatterGroup(const Array_<MultiplierIndex>& mults, const Vector& in,
+                  Vector& out) {
+    for (unsigned i=0; i < mults.size(); ++i) out[mults[i]] = in[i];
+}
+
+// Replace symmetric positive definite block A with its Cholesky factor L
+// (lower triangle). Returns false if A is not symmetric, not positive
+// definite, or if its reciprocal condition number is below conditioningTol;
+// A is garbage in that case. The work arrays are resized as needed.
+bool choleskyFactorIfWellConditioned(Matrix& A, Real conditioningTol,
+                                     Array_<double>& work, Array_<int>& iwork)
+{
+    const int n = A.nrow();
+    if (n == 0) return true;
+
+    // Working constraints can make G M^-1 ~G nonsymmetric; we can't use
+    // Cholesky then. Otherwise clean up the roundoff asymmetry.
+    Real scale = TinyReal;
+    for (int j=0; j < n; ++j)
+        for (int i=0; i < n; ++i)
+            scale = std::max(scale, std::abs(A(i,j)));
+    for (int j=0; j < n; ++j)
+        for (int i=j+1; i < n; ++i) {
+            if (std::abs(A(i,j)-A(j,i)) > SqrtEps*scale)
+                return false;
+            A(i,j) = A(j,i) = (A(i,j)+A(j,i))/2;
+        }
+
+    int info;
+    work.resize(3*n);
+    iwork.resize(n);
+    const double anorm = dlansy_('1', 'L', n, &A(0,0), n, work.begin());
+    dpotrf_('L', n, &A(0,0), n, info);
+    if (info != 0) return false; // not positive definite
+
+    double rcond;
+    dpocon_('L', n, &A(0,0), n, anorm, rcond, work.begin(), iwork.begin(),
+            info);
+    return info == 0 && rcond >= conditioningTol;
+}
+
+// Solve L*~L x = b in place.
+void choleskySolve(const Matrix& L, Vector& b) {
+    const int n = L.nrow();
+    if (n == 0) return;
+    int info;
+    dpotrs_('L', n, 1, &L(0,0), n, &b[0], n, info);
+    assert(info == 0);
+}
+}
+
+// We expect the previous factors to be close since they typically come from
+// the previous integrator stage or step. Each refinement iteration costs one 
+// O(m+n) multiplyByGMInvGt(), much less than reassembling and refactoring
+// the blocks, so we allow a few before giving up. The tolerance has to be
+// close to what a fresh factorization achieves; any acceleration constraint
+// error left here is integrated into velocity constraint drift.
+static const int  MaxProjectedMInvRefinements = 4;
+static const Real ProjectedMInvRefinementTol  = SignificantReal;
+
+void SimbodyMatterSubsystemRep::
+solveProjectedMInv(const State&     s,
+                   Real             conditioningTol,
+                   const Vector&    rhs,
+                   Vector&          lambda) const
+{
+    const SBInstanceCache& ic = getInstanceCache(s);
+    const Array_< Array_<MultiplierIndex> >& groups = 
+        ic.dynamicallyCoupledMultipliers;
+    const int m = rhs.size();
+    lambda.resize(m);
+    if (m == 0) return;
+
+    const CacheEntryIndex fx = topologyCache.projectedMInvFactorCacheIndex;
+    SBProjectedMInvFactorCache& fc = updProjectedMInvFactorCache(s);
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().solveProjectedMInv;
+    if (!isCacheValueRealized(s, fx)) {
+        // The groups may have changed; we have no factors yet.
+        fc.blockFactor.clear(); fc.blockFactor.resize(groups.size());
+        fc.isFactored.clear();  fc.isFactored.resize(groups.size(), false);
+        markCacheValueRealized(s, fx);
+    }
+
+    // Blocks that we'll have to assemble now, either because we have no 
+    // factor for them or because refinement with the old one didn't work.
+    Array_<bool>& needBlock = scratch.needBlock;
+    needBlock.resize(groups.size());
+    bool anyFactored = false;
+    for (unsigned b=0; b < groups.size(); ++b) {
+        needBlock[b] = !fc.isFactored[b];
+        anyFactored = anyFactored || fc.isFactored[b];
+    }
+
+    lambda.setToZero();
+    // Each group's segment of a multiplier-like vector.
+    scratch.rb.resize(groups.size());
+
+    // Try the factors we already have, refining the solution against the
+    // current G M^-1 ~G. The blocks are decoupled so each one's residual
+    // depends only on its own multipliers and they converge (or don't) 
+    // independently.
+    if (anyFactored) {
+        Vector& bias          = scratch.bias;
+        Vector& residual      = scratch.residual;
+        Vector& GMInvGtLambda = scratch.GMInvGtLambda;
+        calcBiasForMultiplyByPVA(s,true,true,true,bias);
+
+        residual = rhs;
+        const Real tol = ProjectedMInvRefinementTol*rhs.normInf();
+        Array_<bool>& refining = scratch.refining;
+        Array_<Real>& prevNorm = scratch.prevNorm;
+        refining = fc.isFactored;
+        prevNorm.assign(groups.size(), Infinity);
+        for (int iter=0; iter <= MaxProjectedMInvRefinements; ++iter) {
+            for (unsigned b=0; b < groups.size(); ++b) {
+                if (!refining[b]) continue;
+                Vector& rb = scratch.rb[b];
+                gatherGroup(groups[b], residual, rb);
+                choleskySolve(fc.blockFactor[b], rb);
+                for (unsigned i=0; i < groups[b].size(); ++i)
+                    lambda[groups[b][i]] += rb[i];
+            }
+            multiplyByGMInvGt(s, bias, lambda, GMInvGtLambda);
+            residual = rhs; residual -= GMInvGtLambda;
+
+            bool anyRefining = false;
+            for (unsigned b=0; b < groups.size(); ++b) {
+                if (!refining[b]) continue;
+                Vector& rb = scratch.rb[b];
+                gatherGroup(groups[b], residual, rb);
+                const Real norm = rb.size() ? rb.normInf() : Real(0);
+                if (norm <= tol) {
+                    refining[b] = false; // success
+                } else if (!(norm < prevNorm[b]/2)
+                           || iter == MaxProjectedMInvRefinements) {
+                    // Not converging fast enough (or NaN); refactor.
+                    refining[b] = false; 
+                    needBlock[b] = true;
+                } else {
+                    prevNorm[b] = norm;
+                    anyRefining = true;
+                }
+            }
+            if (!anyRefining) break;
+        }
+    }
+
+    bool anyNeeded = false;
+    for (unsigned b=0; b < groups.size(); ++b)
+        anyNeeded = anyNeeded || needBlock[b];
+    if (!anyNeeded)
+        return;
+
+    // Assemble and factor the remaining blocks from scratch.
+    Array_<Matrix>& blocks = scratch.blocks;
+    calcGMInvGtBlocks(s, needBlock, blocks);
+
+    for (unsigned b=0; b < groups.size(); ++b) {
+        if (!needBlock[b]) continue;
+        Vector& rb = scratch.rb[b];
+        gatherGroup(groups[b], rhs, rb);
+        Matrix& L = fc.blockFactor[b];
+        L = blocks[b];
+        fc.isFactored[b] = choleskyFactorIfWellConditioned(L, conditioningTol,
+                                                 scratch.work, scratch.iwork);
+        if (fc.isFactored[b]) {
+            ++fc.numFactorizations;
+            choleskySolve(L, rb);
+        } else {
+            // Not safely positive definite; use the rank-revealing 
+            // factorization to deal with redundant constraints. We'll try
+            // this block again next time.
+            L.clear();
+            FactorQTZ qtz(blocks[b], conditioningTol);
+            Vector xb;
+            qtz.solve(rb, xb);
+            rb = xb;
+        }
+        scatterGroup(groups[b], rb, lambda);
+    }
+}
+
+
+
+// =============================================================================
+//                    FIND DYNAMICALLY COUPLED MULTIPLIERS
+// =============================================================================
+// Two constraints are coupled through M^-1 if any of their constrained bodies
+// or constrained mobilizers are in the same base body subtree. We find the
+// connected sets of base bodies using union-find and then collect the 
+// multipliers of the constraints in each set. A constraint that touches only
+// Ground is in a group by itself.
+void SimbodyMatterSubsystemRep::
+findDynamicallyCoupledMultipliers(const State& s, SBInstanceCache& ic) const {
+    const int mHolo    = ic.totalNHolonomicConstraintEquationsInUse;
+    const int mNonholo = ic.totalNNonholonomicConstraintEquationsInUse;
+
+    Array_<MobilizedBodyIndex,MobilizedBodyIndex> 
+        parentSet(getNumMobilizedBodies());
+    for (MobilizedBodyIndex mbx(0); mbx < parentSet.size(); ++mbx)
+        parentSet[mbx] = mbx;
+    auto findSet = [&parentSet](MobilizedBodyIndex mbx) {
+        while (parentSet[mbx] != mbx)
+            mbx = parentSet[mbx] = parentSet[parentSet[mbx]];
+        return mbx;
+    };
+
+    // Record one base body for each enabled constraint and join the sets of
+    // all its base bodies.
+    Array_<MobilizedBodyIndex,ConstraintIndex> consBase(constraints.size());
+    for (ConstraintIndex cx(0); cx < constraints.size(); ++cx) {
+        const ConstraintImpl& crep = getConstraint(cx).getImpl();
+        if (crep.isDisabled(s)) continue;
+
+        Array_<MobilizedBodyIndex> mobods;
+        for (ConstrainedBodyIndex cbx(0); 
+             cbx < crep.getNumConstrainedBodies(); ++cbx)
+            mobods.push_back(crep.getMobilizedBodyIndexOfConstrainedBody(cbx));
+        for (ConstrainedMobilizerIndex cmx(0); 
+             cmx < crep.getNumConstrainedMobilizers(); ++cmx)
+            mobods.push_back
+               (crep.getMobilizedBodyIndexOfConstrainedMobilizer(cmx));
+
+        for (MobilizedBodyIndex mbx : mobods) {
+            const MobilizedBodyIndex base = 
+                getMobilizedBody(mbx).getImpl()
+                                     .getMyBaseBodyMobilizedBodyIndex();
+            if (base == GroundIndex) continue;
+            if (!consBase[cx].isValid()) consBase[cx] = base;
+            else parentSet[findSet(base)] = findSet(consBase[cx]);
+        }
+    }
+
+    Array_<int,MobilizedBodyIndex> groupOfSet(getNumMobilizedBodies(), -1);
+    Array_< Array_<MultiplierIndex> >& groups = 
+        ic.dynamicallyCoupledMultipliers;
+    groups.clear();
+    for (ConstraintIndex cx(0); cx < constraints.size(); ++cx) {
+        const SBInstancePerConstraintInfo& cInfo = 
+            ic.getConstraintInstanceInfo(cx);
+        const int mp = cInfo.holoErrSegment.length;
+        const int mv = cInfo.nonholoErrSegment.length;
+        const int ma = cInfo.accOnlyErrSegment.length;
+        if (mp+mv+ma == 0) continue; // includes disabled constraints
+
+        int g;
+        if (!consBase[cx].isValid()) {
+            g = (int)groups.size(); groups.push_back(); // Ground only
+        } else {
+            int& gs = groupOfSet[findSet(consBase[cx])];
+            if (gs < 0) {gs = (int)groups.size(); groups.push_back();}
+            g = gs;
+        }
+
+        // Multiplier order is all the holonomic ones, then nonholonomic,
+        // then acceleration-only; see ConstraintImpl::
+        // getIndexOfMultipliersInUse().
+        Array_<MultiplierIndex>& mults = groups[g];
+        for (int i=0; i < mp; ++i)
+            mults.push_back(MultiplierIndex(cInfo.holoErrSegment.offset + i));
+        for (int i=0; i < mv; ++i)
+            mults.push_back(MultiplierIndex(mHolo 
+                                + cInfo.nonholoErrSegment.offset + i));
+        for (int i=0; i < ma; ++i)
+            mults.push_back(MultiplierIndex(mHolo + mNonholo
+                                + cInfo.accOnlyErrSegment.offset + i));
+    }
+
+    ic.maxNDynamicallyCoupledMultipliers = 0;
+    for (unsigned g=0; g < groups.size(); ++g) {
+        std::sort(groups[g].begin(), groups[g].end());
+        ic.maxNDynamicallyCoupledMultipliers = 
+            std::max(ic.maxNDynamicallyCoupledMultipliers, (int)groups[g].size());
+    }
+}
 
 
 
@@ -3570,13 +4217,10 @@ solveForConstraintImpulses(const State&     state,
                            const Vector&    deltaV,
                            Vector&          impulse) const
 {
-    Matrix GMInvGt;
-    calcGMInvGt(state, GMInvGt);
     // MUST DUPLICATE SIMBODY'S METHOD HERE:
-    const Real conditioningTol = GMInvGt.nrow() 
+    const Real conditioningTol = deltaV.size() 
                                     * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-    qtz.solve(deltaV, impulse);
+    solveProjectedMInv(state, conditioningTol, deltaV, impulse);
 }
 
 
@@ -3689,11 +4333,14 @@ calcConstraintAccelerationErrors
     ArrayView_<Real>                    allAerr (&pvaerr[0],  &pvaerr[0]  + m );
 
     // These arrays will be resized and filled with the input needs of each 
-    // Constraint in turn. We're declaring them outside the loop to minimize 
-    // heap allocation (resizing down doesn't normally free heap space). 
-    Array_<SpatialVec,ConstrainedBodyIndex> A_AB;
-    Array_<Real,ConstrainedQIndex> qdd; // holonomic only
-    Array_<Real,ConstrainedUIndex> ud;  // nonholonomic or acc-only
+    // Constraint in turn. They are kept in the State's scratch cache so that
+    // they retain their heap space from call to call (resizing down doesn't 
+    // normally free heap space). 
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().calcConstraintAccelerationErrors;
+    Array_<SpatialVec,ConstrainedBodyIndex>& A_AB = scratch.A_AB;
+    Array_<Real,ConstrainedQIndex>& qdd = scratch.qdd; // holonomic only
+    Array_<Real,ConstrainedUIndex>& ud  = scratch.ud;  // nonholonomic/acc-only
 
     // Loop over all enabled constraints, ask them to generate constraint
     // errors, and collect those in the output argument pvaerr.
@@ -4125,7 +4772,12 @@ int SimbodyMatterSubsystemRep::projectQ
 
     // Determine norms on entry.
     int worstPerr, worstQuatErr;
-    Vector scaledPerrs = pErrs.rowScale(perrWeights);
+    // Temporaries come from the State's scratch cache so that projecting
+    // during time stepping doesn't have to allocate.
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().projectQ;
+    Vector& scaledPerrs = scratch.scaledPerrs;
+    scaledPerrs = pErrs; scaledPerrs.rowScaleInPlace(perrWeights);
     const Real perrNormOnEntry = useNormInf ? scaledPerrs.normInf(&worstPerr)
                                             : scaledPerrs.normRMS(&worstPerr);
     const Real quatNormOnEntry = useNormInf ? quatErrs.normInf(&worstQuatErr)
@@ -4242,7 +4894,8 @@ int SimbodyMatterSubsystemRep::projectQ
     // We always use absolute scaling for q's, derived from the absolute
     // scaling of u's.
     const Vector& uWeights = getUWeights(s);    // 1/unit change (Wu)
-    const Vector uAbsScale = uWeights.elementwiseInvert(); // Wu^-1
+    Vector& uAbsScale = scratch.uAbsScale;
+    uAbsScale = uWeights; uAbsScale.elementwiseInvertInPlace(); // Wu^-1
 
     Real lastChangeMadeWRMS = 0; // size of last change in weighted dq
     int nItsUsed = 0;
@@ -4259,11 +4912,17 @@ int SimbodyMatterSubsystemRep::projectQ
 
     // Keep the starting q in case we have to restore it, which we'll do
     // if the attempts here make the constraint norm worse.
-    const Vector saveQ = getQ(s);
-
-    Matrix Pqwrt(nfq,mHolo);
-    Vector dfq_WLS(nfq), du(nu), dq(nq); // = Wq^+ dq_WLS
-    Vector udfq_WLS(hasPrescribedMotion ? nq : 0); // unpacked if needed
+    Vector& saveQ = scratch.saveQ;
+    saveQ = getQ(s);
+
+    Matrix& Pqwrt = scratch.Pqwrt;
+    Vector& dfq_WLS = scratch.dfq_WLS;
+    Vector& du = scratch.du;
+    Vector& dq = scratch.dq; // = Wq^+ dq_WLS
+    Vector& udfq_WLS = scratch.udfq_WLS; // unpacked if needed
+    Pqwrt.resize(nfq,mHolo);
+    dfq_WLS.resize(nfq); du.resize(nu); dq.resize(nq);
+    udfq_WLS.resize(hasPrescribedMotion ? nq : 0);
     udfq_WLS.setToZero(); // must initialize unwritten elements
     FactorQTZ Pqwr_qtz;
     Real prevPerrNormAchieved = perrNormAchieved; // watch for divergence
@@ -4303,7 +4962,7 @@ int SimbodyMatterSubsystemRep::projectQ
         // Now recalculate the position constraint errors at the new q.
         realizeSubsystemPosition(s); // pErrs changes here
 
-        scaledPerrs = pErrs.rowScale(perrWeights); // Tp * pErrs
+        scaledPerrs = pErrs; scaledPerrs.rowScaleInPlace(perrWeights); // Tp*pErrs
         perrNormAchieved = useNormInf ? scaledPerrs.normInf()
                                       : scaledPerrs.normRMS();
         ++nItsUsed;
@@ -4313,7 +4972,7 @@ int SimbodyMatterSubsystemRep::projectQ
             // perr norm got worse; restore to end of previous iteration
             updQ(s) += dq;
             realizeSubsystemPosition(s); // pErrs changes here
-            scaledPerrs = pErrs.rowScale(perrWeights);
+            scaledPerrs = pErrs; scaledPerrs.rowScaleInPlace(perrWeights);
             perrNormAchieved = useNormInf ? scaledPerrs.normInf()
                                           : scaledPerrs.normRMS();
             diverged = true;
@@ -4384,13 +5043,15 @@ int SimbodyMatterSubsystemRep::projectQ
     // N^+*N.)
     if (qErrest.size()) {
         // Work in Wq-norm
-        Vector Tp_Pq_qErrest, bias_p;
+        Vector& Tp_Pq_qErrest = scratch.Tp_Pq_qErrest;
+        Vector& bias_p = scratch.bias_p;
         calcBiasForMultiplyByPq(s, bias_p);
 
         // Switch back to unweighted dq = Wq^+ * dq_WLS
         // = N * Wu^-1 * N^+ * dq_WLS
         if (hasPrescribedMotion) {
-            Vector qErrest_0(qErrest);
+            Vector& qErrest_0 = scratch.qErrest_0;
+            qErrest_0 = qErrest;
             zeroKnownQ(s, qErrest_0); // zero out prescribed entries
             multiplyByPq(s, bias_p, qErrest_0, Tp_Pq_qErrest); // (Pq*qErrest)_r
             Tp_Pq_qErrest.rowScaleInPlace(perrWeights); // now Tp*(Pq*qErrest)_r
@@ -4696,7 +5357,11 @@ int SimbodyMatterSubsystemRep::projectU
 
     // Determine norm on entry.
     int worstPVerr;
-    Vector scaledPVerrs = pvErrs.rowScale(pverrWeights);
+    // Temporaries come from the State's scratch cache; see projectQ().
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().projectU;
+    Vector& scaledPVerrs = scratch.scaledPVerrs;
+    scaledPVerrs = pvErrs; scaledPVerrs.rowScaleInPlace(pverrWeights);
     const Real pverrNormOnEntry = useNormInf ? scaledPVerrs.normInf(&worstPVerr)
                                              : scaledPVerrs.normRMS(&worstPVerr);
     
@@ -4776,7 +5441,8 @@ int SimbodyMatterSubsystemRep::projectU
     // Calculate relative scaling for changes to u.
     const Vector& u = getU(s);
     const Vector& uWeights = getUWeights(s); // 1/unit change (Wu)
-    Vector uRelScale(nu);
+    Vector& uRelScale = scratch.uRelScale;
+    uRelScale.resize(nu);
     for (int i=0; i<nu; ++i) {
         const Real ui = std::abs(u[i]);
         const Real wi = uWeights[i];
@@ -4796,11 +5462,14 @@ int SimbodyMatterSubsystemRep::projectU
 
     // Keep the starting u in case we have to restore it, which we'll do
     // if the attempts here make the constraint norm worse.
-    const Vector saveU = getU(s);
-
-    Matrix PVwrt(nfu, mHolo+mNonholo);
-    Vector dfu_WLS(nfu);
-    Vector du(nu); // unpacked into here if necessary
+    Vector& saveU = scratch.saveU;
+    saveU = getU(s);
+
+    Matrix& PVwrt = scratch.PVwrt;
+    Vector& dfu_WLS = scratch.dfu_WLS;
+    Vector& du = scratch.du; // unpacked into here if necessary
+    PVwrt.resize(nfu, mHolo+mNonholo);
+    dfu_WLS.resize(nfu); du.resize(nu);
     if (hasPrescribedMotion)
         du.setToZero(); // must initialize unwritten elements
 
@@ -4827,14 +5496,14 @@ int SimbodyMatterSubsystemRep::projectU
             unpackFreeU(s, dfu_WLS, du);    // zeroes in u_p slots
             du.rowScaleInPlace(uRelScale); // du=Eu^-1*unpack(dfu_WLS)
         } else {
-            du = dfu_WLS.rowScale(uRelScale); // unscale: du=Eu^-1*du_WLS
+            du = dfu_WLS; du.rowScaleInPlace(uRelScale); // du=Eu^-1*du_WLS
         }
         updU(s) -= du;
         results.setAnyChangeMade(true);
 
         // Recalculate the constraint errors for the new u's.
         realizeSubsystemVelocity(s);
-        scaledPVerrs = pvErrs.rowScale(pverrWeights); // Tpv * pvErrs
+        scaledPVerrs = pvErrs; scaledPVerrs.rowScaleInPlace(pverrWeights);
         pverrNormAchieved = useNormInf ? scaledPVerrs.normInf()
                                        : scaledPVerrs.normRMS();
         ++nItsUsed;
@@ -4844,7 +5513,7 @@ int SimbodyMatterSubsystemRep::projectU
             // Velocity norm worse -- restore to end of previous iteration.
             updU(s) += du;
             realizeSubsystemVelocity(s); // pvErrs changes here
-            scaledPVerrs = pvErrs.rowScale(pverrWeights);
+            scaledPVerrs = pvErrs; scaledPVerrs.rowScaleInPlace(pverrWeights);
             pverrNormAchieved = useNormInf ? scaledPVerrs.normInf()
                                            : scaledPVerrs.normRMS();
             diverged = true;
@@ -4912,11 +5581,14 @@ int SimbodyMatterSubsystemRep::projectU
 
     if (uErrest.size()) {
         // Work in Wu-norm
-        Vector Tpv_PV_uErrest(mHolo+mNonholo);
-        Vector bias_pv(mHolo+mNonholo);
+        Vector& Tpv_PV_uErrest = scratch.Tpv_PV_uErrest;
+        Vector& bias_pv = scratch.bias_pv;
+        Tpv_PV_uErrest.resize(mHolo+mNonholo);
+        bias_pv.resize(mHolo+mNonholo);
         calcBiasForMultiplyByPVA(s,true,true,false,bias_pv); // just P,V
         if (hasPrescribedMotion) {
-            Vector uErrest_0(uErrest);
+            Vector& uErrest_0 = scratch.uErrest_0;
+            uErrest_0 = uErrest;
             zeroKnownU(s, uErrest_0); // zero out prescribed entries
             multiplyByPVA(s,true,true,false,bias_pv,
                             uErrest_0,Tpv_PV_uErrest);
@@ -4986,22 +5658,27 @@ void SimbodyMatterSubsystemRep::calcTreeForwardDynamicsOperator(
     udot.resize(topologyCache.nDOFs);
     qdotdot.resize(topologyCache.maxNQs);
 
-    Vector              totalMobilityForces;
-    Vector_<SpatialVec> totalBodyForces;
-
     // inputs
 
     // First assume we'll use the input forces as-is.
     const Vector*              mobilityForcesToUse  = &mobilityForces;
     const Vector_<SpatialVec>* bodyForcesToUse      = &bodyForces;
 
+    // If not, we'll form the totals in the State's scratch cache.
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().calcTreeForwardDynamicsOperator;
+
     if (extraMobilityForces) {
-        totalMobilityForces = mobilityForces - *extraMobilityForces; // note sign
+        Vector& totalMobilityForces = scratch.totalMobilityForces;
+        totalMobilityForces  = mobilityForces; 
+        totalMobilityForces -= *extraMobilityForces; // note sign
         mobilityForcesToUse = &totalMobilityForces;
     }
 
     if (extraBodyForces) {
-        totalBodyForces = bodyForces - *extraBodyForces;    // note sign
+        Vector_<SpatialVec>& totalBodyForces = scratch.totalBodyForces;
+        totalBodyForces  = bodyForces;
+        totalBodyForces -= *extraBodyForces;    // note sign
         bodyForcesToUse = &totalBodyForces;
     }
 
@@ -5119,25 +5796,20 @@ void SimbodyMatterSubsystemRep::calcLoopForwardDynamicsOperator
 
     // Calculate multipliers lambda as
     //     (G M^-1 ~G) lambda = aerr
-    // The method here calculates the mXm matrix G*M^-1*G^T as fast as 
-    // I know how to do, O(m*n) with O(n) temporary memory, using a series
-    // of O(n) operators. Then we'll factor it here in O(m^3) time. 
-    Matrix GMInvGt(m,m);
-    calcGMInvGt(s, GMInvGt);
-    
-    // specify 1/cond at which we declare rank deficiency
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-
-    //printf("fwdDynamics: m=%d condTol=%g rank=%d rcond=%g\n",
-    //    GMInvGt.nrow(), conditioningTol, qtz.getRank(),
-    //    qtz.getRCondEstimate());
-
-    qtz.solve(udotErr, multipliers);
+    // G*M^-1*G^T is block diagonal after permutation, with one block for
+    // each group of dynamically coupled constraints. We assemble only those
+    // blocks, in O(k*n) time where k is the largest block size, and factor 
+    // them in O(sum(mb^3)) time. The factors are kept in the State and reused
+    // as long as they remain good enough, usually across many integrator 
+    // stages, in which case the cost is just a few O(n) operator sequences.
+    solveProjectedMInv(s, conditioningTol, udotErr, multipliers);
 
     // We have the multipliers, now turn them into forces.
 
-    Vector_<SpatialVec> bodyForcesInG;
-    Vector              mobilityF;
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().calcLoopForwardDynamicsOperator;
+    Vector_<SpatialVec>& bodyForcesInG = scratch.bodyForcesInG;
+    Vector&              mobilityF     = scratch.mobilityF;
     calcConstraintForcesFromMultipliers(s,multipliers,bodyForcesInG,mobilityF,
         cac.constrainedBodyForcesInG, cac.constraintMobilityForces);
     // Note that constraint forces have the opposite sign from applied forces
@@ -5324,22 +5996,18 @@ void SimbodyMatterSubsystemRep::calcTreeAccelerations(const State& s,
     for (int i=0; i < (int)ic.zeroUDot.size(); ++i)
         udotPtr[ic.zeroUDot[i]] = 0;
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcUDotPass1Inward(ic,tpc,abc,abvc,
-                mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr,
-                hingeForcePtr);
-        }
+    sweepTipToBase(CheapSweep, [&](const RigidBodyNode& node) {
+        node.calcUDotPass1Inward(ic,tpc,abc,abvc,
+            mobilityForcePtr, bodyForcePtr, udotPtr, zPtr, zPlusPtr,
+            hingeForcePtr);
+    });
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcUDotPass2Outward(ic,tpc,abc,tvc,dc, 
-                hingeForcePtr, aPtr, udotPtr, tauPtr);
-            node.calcQDotDot(sbs, &udotPtr[node.getUIndex()], 
-                             &qdotdotPtr[node.getQIndex()]);
-        }
+    sweepBaseToTip(CheapSweep, [&](const RigidBodyNode& node) {
+        node.calcUDotPass2Outward(ic,tpc,abc,tvc,dc, 
+            hingeForcePtr, aPtr, udotPtr, tauPtr);
+        node.calcQDotDot(sbs, &udotPtr[node.getUIndex()], 
+                         &qdotdotPtr[node.getQIndex()]);
+    });
 }
 //......................... CALC TREE ACCELERATIONS ............................
 
@@ -5376,27 +6044,27 @@ void SimbodyMatterSubsystemRep::multiplyByMInv(const State& s,
     assert(f.hasContiguousData());
     assert(MInvf.hasContiguousData());
 
-    // Temporaries
-    Array_<Real>        eps(nu);
-    Array_<SpatialVec>  z(nb), zPlus(nb), A_GB(nb);
+    // Temporaries, from the State's scratch cache.
+    SBScratchCacheLease scratchLease;
+    auto& scratch = scratchLease.upd().multiplyByMInv;
+    Array_<Real>&       eps   = scratch.eps;   eps.resize(nu);
+    Array_<SpatialVec>& z     = scratch.z;     z.resize(nb);
+    Array_<SpatialVec>& zPlus = scratch.zPlus; zPlus.resize(nb);
+    Array_<SpatialVec>& A_GB  = scratch.A_GB;  A_GB.resize(nb);
 
     // Point to raw data of input arguments.
     const Real* fPtr     = &f[0];       
     Real*       MInvfPtr = &MInvf[0];
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMInvPass1Inward(ic,tpc,abc,
-                fPtr, z.begin(), zPlus.begin(), eps.begin());
-        }
+    sweepTipToBase(CheapSweep, [&](const RigidBodyNode& node) {
+        node.multiplyByMInvPass1Inward(ic,tpc,abc,
+            fPtr, z.begin(), zPlus.begin(), eps.begin());
+    });
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.multiplyByMInvPass2Outward(ic,tpc,abc, 
-                eps.cbegin(), A_GB.begin(), MInvfPtr);
-        }
+    sweepBaseToTip(CheapSweep, [&](const RigidBodyNode& node) {
+        node.multiplyByMInvPass2Outward(ic,tpc,abc, 
+            eps.cbegin(), A_GB.begin(), MInvfPtr);
+    });
 }
 //............................. CALC M INVERSE F ...............................
 
@@ -5598,21 +6266,17 @@ void SimbodyMatterSubsystemRep::calcTreeResidualForces(const State& s,
                         ? &residualMobilityForces[0] : NULL;
     SpatialVec* tempPtr = allFTmp.size() ? &allFTmp[0] : NULL;
 
-    for (int i=0 ; i<(int)rbNodeLevels.size() ; i++)
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcBodyAccelerationsFromUdotOutward
-               (tpc,tvc,knownUdotPtr,aPtr);
-        }
+    sweepBaseToTip(CheapSweep, [&](const RigidBodyNode& node) {
+        node.calcBodyAccelerationsFromUdotOutward
+           (tpc,tvc,knownUdotPtr,aPtr);
+    });
 
-    for (int i=rbNodeLevels.size()-1 ; i>=0 ; i--) 
-        for (int j=0 ; j<(int)rbNodeLevels[i].size() ; j++) {
-            const RigidBodyNode& node = *rbNodeLevels[i][j];
-            node.calcInverseDynamicsPass2Inward(
-                tpc,tvc,aPtr,
-                mobilityForcePtr,bodyForcePtr,
-                tempPtr,residualPtr);
-        }
+    sweepTipToBase(CheapSweep, [&](const RigidBodyNode& node) {
+        node.calcInverseDynamicsPass2Inward(
+            tpc,tvc,aPtr,
+            mobilityForcePtr,bodyForcePtr,
+            tempPtr,residualPtr);
+    });
 }
 //........................ CALC TREE RESIDUAL FORCES ...........................
 
@@ -6335,7 +6999,10 @@ void SimbodyMatterSubsystemRep::multiplyBySystemJacobianTranspose
 
     const SBTreePositionCache& tpc = getTreePositionCache(s);
 
-    Vector_<SpatialVec> zTemp(getNumBodies()); zTemp.setToZero();
+    SBScratchCacheLease scratchLease;
+    Vector_<SpatialVec>& zTemp = 
+        scratchLease.upd().multiplyBySystemJacobianTranspose.zTemp;
+    zTemp.resize(getNumBodies()); zTemp.setToZero();
     const SpatialVec* xPtr = X.size() ? &X[0] : NULL;
     Real* jtxPtr = JtX.size() ? &JtX[0] : NULL;
     SpatialVec* zPtr = zTemp.size() ? &zTemp[0] : NULL;
@@ -6397,6 +7064,31 @@ void SimbodyMatterSubsystemRep::setShowDefaultGeometry(bool show) {
     showDefaultGeometry = show;
 }
 
+void SimbodyMatterSubsystemRep::setNumberOfThreads(unsigned numThreads) {
+    SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "SimbodyMatterSubsystemRep",
+                "setNumberOfThreads", "Number of threads must be positive");
+    std::lock_guard<std::mutex> lock(treeSweepExecutorLock);
+    if (numThreads == 1) treeSweepExecutor.reset();
+    else treeSweepExecutor = new ParallelExecutor(numThreads);
+    hasTreeSweepExecutor = !treeSweepExecutor.empty();
+}
+
+int SimbodyMatterSubsystemRep::getNumberOfThreads() const {
+    std::lock_guard<std::mutex> lock(treeSweepExecutorLock);
+    return treeSweepExecutor.empty() ? 1 : treeSweepExecutor->getMaxThreads();
+}
+
+void SimbodyMatterSubsystemRep::setParallelLevelCostThreshold(Real flops) {
+    SimTK_APIARGCHECK1_ALWAYS(flops >= 0, "SimbodyMatterSubsystemRep",
+        "setParallelLevelCostThreshold", 
+        "The cost threshold must be nonnegative but was %g.", flops);
+    parallelLevelCostThreshold = flops;
+}
+
+Real SimbodyMatterSubsystemRep::getParallelLevelCostThreshold() const {
+    return parallelLevelCostThreshold;
+}
+
 std::ostream& operator<<(std::ostream& o, const SimbodyMatterSubsystemRep& tree) {
     o << "SimbodyMatterSubsystemRep has " << tree.getNumBodies() << " bodies (incl. G) in "
       << tree.rbNodeLevels.size() << " levels." << std::endl;
@@ -48,6 +48,8 @@ using std::pair;
 #include <map>
 #include <set>
 #include <algorithm>
+#include <mutex>
+#include <atomic>
 
 class RigidBodyNode;
 class RBDistanceConstraint;
@@ -141,7 +143,9 @@ private:
 class SimbodyMatterSubsystemRep : public SimTK::Subsystem::Guts {
 public:
     SimbodyMatterSubsystemRep() 
-      : Subsystem::Guts("SimbodyMatterSubsystem", "0.7.1")
+      : Subsystem::Guts("SimbodyMatterSubsystem", "0.7.1"),
+        parallelLevelCostThreshold(DefaultParallelLevelCostThreshold),
+        useStructureOfArraysKinematics(false)
     { 
         clearTopologyCache();
     }
@@ -937,6 +941,43 @@ public:
     void calcGMInvGt(const State&   state,
                      Matrix&        GMInvGt) const;
 
+    // Calculate just the diagonal blocks of G M^-1 ~G, one for each group of
+    // dynamically coupled multipliers in the InstanceCache for which `which`
+    // is true (the others are returned empty); everything outside those 
+    // blocks is known to be zero. Multipliers in different 
+    // groups can't interact, so we can pluck out one column from every block 
+    // with a single sequence of O(n) operators. The cost is thus O(k*n) where 
+    // k is the size of the largest group, rather than O(m*n).
+    void calcGMInvGtBlocks(const State&         state,
+                           const Array_<bool>&  which,
+                           Array_<Matrix>&      blocks) const;
+
+    // Form the product GMInvGtx = G M^-1 ~G * x in O(m+n) time without 
+    // forming the matrix. A precalculated bias from calcBiasForMultiplyByPVA()
+    // with all of P,V,A included must be supplied.
+    void multiplyByGMInvGt(const State&     state,
+                           const Vector&    bias,
+                           const Vector&    x,
+                           Vector&          GMInvGtx) const;
+
+    // Solve (G M^-1 ~G) lambda = rhs for lambda, block by block. Cholesky
+    // factors of the blocks are kept in the State and reused (with iterative
+    // refinement against the current matrix) as long as that is cheap and
+    // accurate; otherwise that block is reassembled and refactored. Blocks
+    // that aren't safely positive definite are solved with FactorQTZ instead
+    // using the given conditioning tolerance so that redundant constraints
+    // are dealt with exactly as before; that doesn't affect the reuse of the
+    // other blocks' factors.
+    void solveProjectedMInv(const State&    state,
+                            Real            conditioningTol,
+                            const Vector&   rhs,
+                            Vector&         lambda) const;
+
+    // Called at the end of realizeInstance() to partition the multipliers in
+    // use into dynamically decoupled groups.
+    void findDynamicallyCoupledMultipliers(const State&       state,
+                                           SBInstanceCache&   ic) const;
+
     // Use factored GMInvGt to solve GMinvGt*impulse=deltaV. The main benefit
     // of this method is that it promises to use the same method Simbody does
     // to deal with constraint redundancies.
@@ -1139,6 +1180,15 @@ public:
             (s.updCacheEntry(getMySubsystemIndex(),topologyCache.constrainedAccelerationCacheIndex)).upd();
     }
 
+    const SBProjectedMInvFactorCache& getProjectedMInvFactorCache(const State& s) const {
+        return Value<SBProjectedMInvFactorCache>::downcast
+            (s.getCacheEntry(getMySubsystemIndex(),topologyCache.projectedMInvFactorCacheIndex)).get();
+    }
+    SBProjectedMInvFactorCache& updProjectedMInvFactorCache(const State& s) const { //mutable
+        return Value<SBProjectedMInvFactorCache>::updDowncast
+            (s.updCacheEntry(getMySubsystemIndex(),topologyCache.projectedMInvFactorCacheIndex)).upd();
+    }
+
 
     const SBModelVars& getModelVars(const State& s) const {
         return Value<SBModelVars>::downcast
@@ -1210,6 +1260,23 @@ public:
     bool getShowDefaultGeometry() const;
     void setShowDefaultGeometry(bool show);
 
+    void setNumberOfThreads(unsigned numThreads);
+    int getNumberOfThreads() const;
+    void setParallelLevelCostThreshold(Real flops);
+    Real getParallelLevelCostThreshold() const;
+
+    // This is a topology-stage switch that is deliberately not part of the
+    // SimbodyMatterSubsystem API: with SSE2 code generation the batched pass
+    // is slower than doing the bodies one at a time. It is here so that it
+    // can be tested and timed (see tests/adhoc/SpatialKernelBenchmark.cpp)
+    // on targets with wider SIMD.
+    void setUseStructureOfArraysKinematics(bool useSoA) {
+        invalidateSubsystemTopologyCache();
+        useStructureOfArraysKinematics = useSoA;
+    }
+    bool getUseStructureOfArraysKinematics() const 
+    {   return useStructureOfArraysKinematics; }
+
     void calcTreeForwardDynamicsOperator(const State&,
         const Vector&                   mobilityForces,
         const Vector_<Vec3>&            particleForces,
@@ -1340,6 +1407,50 @@ private:
     // Our realizeTopology method calls this after all bodies & constraints have been added,
     // to construct part of the topology cache below.
     void endConstruction(State&);
+
+        // LEVEL-PARALLEL TREE SWEEPS
+
+    // Nodes on the same level of the tree never depend on one another during
+    // a base-to-tip or tip-to-base recursion, so the nodes of a level can be
+    // processed concurrently. We only do that if the user asked for more than
+    // one thread and the estimated cost of the level is high enough to pay for
+    // waking up the worker threads; otherwise we sweep serially as usual.
+
+    // The per-node work differs a lot between recursions: articulated body
+    // inertias and position kinematics cost O(dof^3) flops per node while the
+    // operator sweeps (e.g. M^-1 f) are only O(dof).
+    enum TreeSweepCost {ExpensiveSweep=0, CheapSweep=1, NumTreeSweepCosts=2};
+
+    // Flops; roughly the cost of waking up the ParallelExecutor's threads.
+    static constexpr Real DefaultParallelLevelCostThreshold = 20000;
+
+    template <class NodeOp>
+    void sweepBaseToTip(TreeSweepCost, const NodeOp&) const;
+    template <class NodeOp>
+    void sweepTipToBase(TreeSweepCost, const NodeOp&) const;
+    template <class NodeOp>
+    void processLevel(int level, TreeSweepCost, const NodeOp&) const;
+    bool shouldProcessLevelInParallel(int level, TreeSweepCost) const;
+
+    // Null unless more than one thread was requested. The executor's threads
+    // are created once and reused for every sweep. The lock prevents two
+    // threads realizing different States of this System from using the
+    // executor at the same time; the loser simply sweeps serially. The 
+    // executor may only be touched while holding the lock; the atomic flag
+    // lets the sweeps skip the lock entirely when running single threaded.
+    mutable ClonePtr<ParallelExecutor>  treeSweepExecutor;
+    mutable std::mutex                  treeSweepExecutorLock;
+    std::atomic<bool>                   hasTreeSweepExecutor{false};
+    Real                                parallelLevelCostThreshold;
+
+    // When set, the joint-independent position kinematics (Phi, p_GBc, and
+    // Mk_G) of all the ordinary mobilized bodies are calculated together in
+    // a structure-of-arrays pass after the base-to-tip position sweep rather
+    // than one body at a time during it. See 
+    // calcJointIndependentKinematicsPosBatched().
+    bool                                useStructureOfArraysKinematics;
+    void calcJointIndependentKinematicsPosBatched(const State&,
+                                                  SBTreePositionCache&) const;
     
         // TOPOLOGY CACHE
 
@@ -1363,6 +1474,16 @@ private:
     Array_<RBNodePtrList>      rbNodeLevels;
     // Map nodeNum (a.k.a. MobilizedBodyIndex) to (level,offset).
     Array_<RigidBodyNodeIndex,MobilizedBodyIndex> nodeNum2NodeMap;
+    // Estimated flops needed to process all the nodes of each level, for
+    // each kind of sweep. Used to decide whether a level is worth doing in
+    // parallel.
+    Array_<Real> rbNodeLevelCost[NumTreeSweepCosts];
+    // The nodes whose joint-independent position kinematics can be done in
+    // the batched pass, in node number order, with their mass properties 
+    // copied into structure-of-arrays form. Inertias are stored xx,yy,zz,
+    // xy,xz,yz.
+    Array_<const RigidBodyNode*> soaKinematicsNodes;
+    Array_<Real> soaMass, soaCOM_B[3], soaG_Bo_B[6];
 
         // Constraints
 
@@ -92,6 +92,8 @@ class SBConstrainedVelocityCache;
 class SBDynamicsCache;
 class SBTreeAccelerationCache;
 class SBConstrainedAccelerationCache;
+class SBProjectedMInvFactorCache;
+class SBScratchCache;
 
 class SBModelVars;
 class SBInstanceVars;
@@ -126,6 +128,7 @@ public:
             nDOFs = maxNQs = sumSqDOFs = -1;
         modelingVarsIndex.invalidate();
         modelingCacheIndex.invalidate();
+        soaKinematicsCacheIndex.invalidate();
         topoInstanceVarsIndex.invalidate();
         valid = false;
     }
@@ -156,7 +159,12 @@ public:
                           articulatedBodyVelocityCacheIndex,
                           dynamicsCacheIndex, 
                           treeAccelerationCacheIndex, 
-                          constrainedAccelerationCacheIndex;
+                          constrainedAccelerationCacheIndex,
+                          projectedMInvFactorCacheIndex;
+
+    // Only allocated if the batched structure-of-arrays calculation of the
+    // joint-independent position kinematics was enabled at topology time.
+    CacheEntryIndex       soaKinematicsCacheIndex;
 
 
     // These are instance variables that exist regardless of modeling
@@ -572,6 +580,16 @@ public:
     int totalNConstrainedMobilizersInUse;
     int totalNConstrainedQInUse; // q,u from the constrained mobilizers
     int totalNConstrainedUInUse; 
+
+    // Partition of the mHolo+mNonholo+mAccOnly constraint equations 
+    // (multipliers) into groups that are decoupled in G M^-1 ~G. The mass 
+    // matrix is block diagonal with one block per base body (level 1) subtree
+    // so constraints whose constrained bodies and mobilizers don't share any
+    // base body have no dynamic interaction. Multipliers are in increasing 
+    // order within each group. This is the "symbolic analysis" that lets us
+    // assemble and factor G M^-1 ~G one diagonal block at a time.
+    Array_< Array_<MultiplierIndex> > dynamicallyCoupledMultipliers;
+    int maxNDynamicallyCoupledMultipliers; // size of largest group
 public:
     void allocate(const SBTopologyCache& topo,
                   const SBModelCache&    model) 
@@ -595,6 +613,9 @@ public:
         totalNConstrainedMobilizersInUse = 0;
         totalNConstrainedQInUse          = 0;
         totalNConstrainedUInUse          = 0; 
+
+        dynamicallyCoupledMultipliers.clear();
+        maxNDynamicallyCoupledMultipliers = 0;
     }
 
 };
@@ -645,6 +666,34 @@ public:
 // soon as possible, so that later calculations (constraint position errors, 
 // prescribed velocities) can access these without a stage violation.
 
+// This is an optional structure-of-arrays copy of the body-frame quantities 
+// that go into the joint-independent position kinematics (Phi, p_GBc, Mk_G),
+// one entry per batched body, so that they can be calculated for many bodies
+// at once by simple loops the compiler can vectorize. Each array holds one
+// scalar component for all the bodies; rotation matrices are stored by rows
+// and symmetric unit inertias as xx,yy,zz,xy,xz,yz. This is scratch space
+// with its own cache entry that exists only when the batched calculation is
+// enabled. See 
+// SimbodyMatterSubsystemRep::calcJointIndependentKinematicsPosBatched().
+class SBTreePositionSoA {
+public:
+    void resize(int nBatched) {
+        for (int i=0; i < 9; ++i) {R_GP[i].resize(nBatched); 
+                                   R_GB[i].resize(nBatched);}
+        for (int i=0; i < 6; ++i) G_Bo_G[i].resize(nBatched);
+        for (int i=0; i < 3; ++i) {p_PB[i].resize(nBatched);
+                                   p_GB[i].resize(nBatched);
+                                   p_PB_G[i].resize(nBatched);
+                                   p_BBc_G[i].resize(nBatched);
+                                   p_GBc[i].resize(nBatched);}
+    }
+
+    // Inputs gathered from the tree position cache.
+    Array_<Real> R_GP[9], p_PB[3], R_GB[9], p_GB[3];
+    // Results to be scattered back.
+    Array_<Real> p_PB_G[3], p_BBc_G[3], p_GBc[3], G_Bo_G[6];
+};
+
 class SBTreePositionCache {
 public:
     const Transform& getX_FM(MobilizedBodyIndex mbx) const {return bodyJointInParentJointFrame[mbx];}
@@ -698,6 +747,11 @@ public:
     // the Ancestor frame rather than Ground.
     Array_<Transform> constrainedBodyConfigInAncestor;   // nacb (X_AB)
 
+    // When this is set, the nodes leave Phi, p_GBc, and Mk_G to be 
+    // calculated for all of them at once after the base-to-tip position 
+    // sweep; see SBTreePositionSoA.
+    bool jointIndependentKinematicsBatched;
+
 public:
     void allocate(const SBTopologyCache& tree,
                   const SBModelCache&    model,
@@ -738,6 +792,8 @@ public:
         bodyCOMInGround[GroundIndex] = Vec3(0);
 
         constrainedBodyConfigInAncestor.resize(nacb);
+
+        jointIndependentKinematicsBatched = false;
     }
 };
 //.......................... TREE POSITION CACHE ...............................
@@ -1230,6 +1286,163 @@ public:
 
 
 
+// =============================================================================
+//                        PROJECTED MINV FACTOR CACHE 
+// =============================================================================
+// Cholesky factors L (with L*~L = block) of the diagonal blocks of 
+// G M^-1 ~G, one per group of dynamically coupled multipliers in the 
+// InstanceCache. This entry depends only on Instance stage so it survives 
+// changes to t, q, and u. The factors are thus usually a little out of date;
+// they are used to get a first solution that is then refined against the 
+// current G M^-1 ~G, and are recalculated only if that refinement doesn't 
+// converge quickly. Each block is handled separately: one that could not be 
+// Cholesky factored (because it is not symmetric positive definite or is ill
+// conditioned) has no factor here and is assembled and solved with FactorQTZ
+// every time, while the others' factors are still reused.
+
+class SBProjectedMInvFactorCache {
+public:
+    Array_<Matrix> blockFactor;    // one per dynamically coupled group
+    Array_<bool>   isFactored;     // is blockFactor[b] usable?
+    // Number of block Cholesky factorizations performed since this entry was
+    // allocated; lets tests check that the factors are being reused.
+    long long      numFactorizations = 0;
+};
+//........................ PROJECTED MINV FACTOR CACHE .........................
+
+
+
+// =============================================================================
+//                               SCRATCH CACHE 
+// =============================================================================
+// Reusable temporaries for the computations done during realization and by
+// the operators that realization uses. Everything here is resized on use, and
+// resizing to a size that has been seen before does no heap allocation, so
+// once a thread has realized a State a few times further realizations don't
+// touch the heap. (Constraint projection still allocates inside its QTZ 
+// factorization and for Matrix column views, as does factoring a 
+// G M^-1 ~G block that turns out to be rank deficient.)
+//
+// These are not kept in the State: operators like multiplyByMInv() are 
+// called concurrently on the same const State, and may call back into one
+// another. Instead a method borrows one of the calling thread's 
+// SBScratchCache objects with an SBScratchCacheLease for the duration of the
+// call. Leases are handed out last-in first-out, so a nested call (even a
+// recursive one) gets a different object than its caller. Each method uses
+// its own members so that a given nesting depth keeps its sizes from call to
+// call.
+
+class SBScratchCache {
+public:
+
+    struct {
+        Array_<Real>        eps;
+        Array_<SpatialVec>  z, zPlus, A_GB;
+    } multiplyByMInv;
+
+    struct {
+        Vector_<SpatialVec> zTemp;
+    } multiplyBySystemJacobianTranspose;
+
+    struct {
+        Vector_<SpatialVec>                     allF_G;
+        Vector                                  ftmp;
+        Array_<SpatialVec,ConstrainedBodyIndex> oneF_G;
+        Array_<Real,ConstrainedUIndex>          onefu;
+        Array_<Real,ConstrainedQIndex>          onefq;
+    } multiplyByPVATranspose;
+
+    struct {
+        Vector_<SpatialVec>                     Julike;
+        Array_<SpatialVec,MobilizedBodyIndex>   allA_GB;
+        Vector                                  qlike;
+        Array_<SpatialVec,ConstrainedBodyIndex> V_AB, A_AB;
+        Array_<Real,ConstrainedQIndex>          qdot;
+        Array_<Real,ConstrainedUIndex>          udot;
+    } multiplyByPVA;
+
+    struct {
+        Array_<SpatialVec,ConstrainedBodyIndex> AC_AB, zeroV_AB;
+        Array_<Real,ConstrainedQIndex>          zeroQDot;
+        Array_<Real,ConstrainedUIndex>          zeroUDot;
+    } calcBiasForMultiplyByPVA;
+
+    struct {
+        Vector Gtx, MInvGtx;
+    } multiplyByGMInvGt;
+
+    struct {
+        Vector Gtcol, MInvGtcol, GMInvGtcol, bias, lambda;
+    } calcGMInvGtBlocks;
+
+    struct {
+        Array_<Vector>  rb; // one per group so each keeps its own size
+        Array_<bool>    needBlock, refining;
+        Array_<Real>    prevNorm;
+        Vector          bias, residual, GMInvGtLambda;
+        Array_<Matrix>  blocks;
+        Array_<double>  work;
+        Array_<int>     iwork;
+    } solveProjectedMInv;
+
+    struct {
+        Vector  scaledPerrs, uAbsScale, saveQ, dfq_WLS, du, dq, udfq_WLS,
+                Tp_Pq_qErrest, bias_p, qErrest_0;
+        Matrix  Pqwrt;
+    } projectQ;
+
+    struct {
+        Vector  scaledPVerrs, uRelScale, saveU, dfu_WLS, du,
+                Tpv_PV_uErrest, bias_pv, uErrest_0;
+        Matrix  PVwrt;
+    } projectU;
+
+    struct {
+        Vector_<SpatialVec> bodyForcesInG;
+        Vector              mobilityF;
+    } calcLoopForwardDynamicsOperator;
+
+    struct {
+        Vector              totalMobilityForces;
+        Vector_<SpatialVec> totalBodyForces;
+    } calcTreeForwardDynamicsOperator;
+
+    struct {
+        Array_<Real> lambdap, lambdav, lambdaa;
+    } calcConstraintForcesFromMultipliers;
+
+    struct {
+        Array_<SpatialVec,ConstrainedBodyIndex> A_AB;
+        Array_<Real,ConstrainedQIndex>          qdd;
+        Array_<Real,ConstrainedUIndex>          ud;
+    } calcConstraintAccelerationErrors;
+
+    // Used by the ConstraintImpl::calc...ErrorsFromState() methods.
+    struct {
+        Array_<Transform,ConstrainedBodyIndex>  X_AB;
+        Array_<SpatialVec,ConstrainedBodyIndex> V_AB;
+        Array_<Real,ConstrainedQIndex>          q;
+        Array_<Real,ConstrainedUIndex>          u;
+    } constraintErrorsFromState;
+};
+
+// Borrow an SBScratchCache belonging to the calling thread for the lifetime
+// of this object. Must be destructed in the reverse order of construction,
+// which is automatic for local variables.
+class SBScratchCacheLease {
+public:
+    SBScratchCacheLease();
+    ~SBScratchCacheLease();
+    SBScratchCache& upd() {return *scratch;}
+private:
+    SBScratchCacheLease(const SBScratchCacheLease&) = delete;
+    SBScratchCacheLease& operator=(const SBScratchCacheLease&) = delete;
+    SBScratchCache* scratch;
+};
+//............................... SCRATCH CACHE ................................
+
+
+
 
 /* 
  * Generalized state variable collection for a SimbodyMatterSubsystem. 
@@ -0,0 +1,125 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SphereSweepAndPrune.h"
+
+#include <algorithm>
+
+using namespace SimTK;
+
+namespace {
+// Sort the indices in order by key, starting from their previous order. 
+// This is O(n) if that order is nearly correct. If it turns out to need more
+// than a few moves per index we stop and use std::sort instead, so the worst
+// case is O(n log n) rather than the O(n^2) of a plain insertion sort.
+void updateSortedOrder(Array_<int>& order, const Array_<Real>& key) {
+    const int n = (int)order.size();
+    const long long maxMoves = 8LL*n;
+    long long moves = 0;
+    for (int k=1; k < n; ++k) {
+        const int index = order[k];
+        const Real value = key[index];
+        int m = k;
+        for (; m > 0 && key[order[m-1]] > value; --m)
+            order[m] = order[m-1];
+        order[m] = index;
+        moves += k-m;
+        if (moves > maxMoves) {
+            std::sort(order.begin(), order.end(), 
+                      [&key](int i, int j) {return key[i] < key[j];});
+            return;
+        }
+    }
+}
+}
+
+void SphereSweepAndPrune::
+findOverlappingPairs(const Array_<Vec3>&              centers,
+                     const Array_<Real>&              radii,
+                     Array_< std::pair<int,int> >&    pairs)
+{
+    const int n = (int)centers.size();
+    assert(radii.size() == centers.size());
+    pairs.clear();
+
+    // Bring the sorted extents up to date on each axis and count the pairs
+    // whose extents overlap along it. That's all the pairs except those 
+    // where one sphere ends before the other starts, and we can count those
+    // in a single merge-like pass over the sorted starts and ends.
+    int bestAxis = 0;
+    double bestCount = Infinity;
+    for (int a=0; a < 3; ++a) {
+        Axis& axis = axes[a];
+        axis.start.resize(n); axis.end.resize(n);
+        for (int i=0; i < n; ++i) {
+            axis.start[i] = centers[i][a] - radii[i];
+            axis.end[i]   = centers[i][a] + radii[i];
+        }
+        if ((int)axis.byStart.size() != n) {
+            // First time, or the spheres changed; sort from scratch.
+            axis.byStart.resize(n); axis.byEnd.resize(n);
+            for (int i=0; i < n; ++i) axis.byStart[i] = axis.byEnd[i] = i;
+            std::sort(axis.byStart.begin(), axis.byStart.end(),
+                [&axis](int i, int j) {return axis.start[i] < axis.start[j];});
+            std::sort(axis.byEnd.begin(), axis.byEnd.end(),
+                [&axis](int i, int j) {return axis.end[i] < axis.end[j];});
+        } else {
+            updateSortedOrder(axis.byStart, axis.start);
+            updateSortedOrder(axis.byEnd,   axis.end);
+        }
+
+        double separated = 0;
+        for (int k=0, p=0; k < n; ++k) {
+            const Real start = axis.start[axis.byStart[k]];
+            while (p < n && axis.end[axis.byEnd[p]] < start) ++p;
+            separated += p;
+        }
+        const double overlapping = 0.5*double(n)*(n-1) - separated;
+        if (overlapping < bestCount) {bestCount = overlapping; bestAxis = a;}
+    }
+
+    // Sweep along the best axis, checking the other two axes before the 
+    // spheres themselves.
+    const Axis& sweep = axes[bestAxis];
+    const Axis& other1 = axes[(bestAxis+1)%3];
+    const Axis& other2 = axes[(bestAxis+2)%3];
+    for (int k=0; k < n; ++k) {
+        const int i = sweep.byStart[k];
+        for (int m=k+1; m < n; ++m) {
+            const int j = sweep.byStart[m];
+            if (sweep.start[j] > sweep.end[i])
+                break; // no more spheres can overlap sphere i
+            if (   other1.start[j] > other1.end[i] 
+                || other1.start[i] > other1.end[j]
+                || other2.start[j] > other2.end[i] 
+                || other2.start[i] > other2.end[j])
+                continue;
+            if ((centers[i]-centers[j]).normSqr() > square(radii[i]+radii[j]))
+                continue;
+            pairs.push_back(i < j ? std::make_pair(i,j) : std::make_pair(j,i));
+        }
+    }
+
+    // Make the result independent of the sort order.
+    std::sort(pairs.begin(), pairs.end());
+}
@@ -0,0 +1,70 @@
+#ifndef SimTK_SIMBODY_SPHERE_SWEEP_AND_PRUNE_H_
+#define SimTK_SIMBODY_SPHERE_SWEEP_AND_PRUNE_H_
+
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simbody/internal/common.h"
+
+#include <utility>
+
+namespace SimTK {
+
+//==============================================================================
+//                          SPHERE SWEEP AND PRUNE
+//==============================================================================
+/* This is the broad phase used by the contact subsystems to find which of a 
+set of bounding spheres are touching. Each sphere's extent is kept sorted along
+all three axes, and we sweep along whichever axis currently separates the 
+spheres best, so clusters spread out along one axis (a pile of parts on a 
+conveyor, say) don't make the sweep O(n^2).
+
+The sorted order is remembered from one call to the next and updated by
+insertion sort, which is O(n) when the spheres have moved only a little
+relative to one another, as they do from one integrator step to the next. If
+the remembered order turns out to be far from the new one (the first call, or
+a State that jumped) the insertion sort gives up after O(n) work and we sort 
+from scratch instead. The order depends on the trajectory being followed, so 
+the owning subsystem keeps one of these in a cache entry of each State rather
+than sharing one among all the States of its System. The remembered order is
+only a hint and doesn't affect the results. */
+class SphereSweepAndPrune {
+public:
+    /* Find every pair (i,j), i < j, of spheres with centers[i] and radii[i]
+    that touch or overlap. The pairs are returned in ascending order. */
+    void findOverlappingPairs(const Array_<Vec3>&              centers,
+                              const Array_<Real>&              radii,
+                              Array_< std::pair<int,int> >&    pairs);
+private:
+    struct Axis {
+        Array_<Real> start, end;        // sphere extents along this axis
+        Array_<int>  byStart, byEnd;    // sphere indices in sorted order
+    };
+
+    Axis axes[3];
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMBODY_SPHERE_SWEEP_AND_PRUNE_H_
@@ -0,0 +1,522 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "simbody/internal/TrajectoryReporter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #if !defined(NOMINMAX)
+    #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace SimTK;
+
+//==============================================================================
+//                               FILE FORMAT
+//==============================================================================
+// All numbers are stored in the native byte order of the writer; the header
+// records the bit pattern of 1.0 so a reader can tell if that doesn't match.
+//
+//  header  "SimTKtrj", u32 version, u32 flags, u32 nq, nu, nz, nMeasures,
+//          u32 samplesPerChunk, f64 1.0
+//  chunks  u32 nSamples, u32 payloadBytes, f64 time[nSamples], payload
+//  index   per chunk: u64 chunkOffset, u64 firstSample, f64 firstTime
+//  footer  u64 indexOffset, u64 nChunks, u64 nSamples, "SimTKidx"
+//
+// The payload holds nSamples records of nq+nu+nz+nMeasures values. If the
+// file is compressed, each value is XORed with the same value in the previous
+// record of the chunk (the first record is XORed with zero) and written as a
+// count of leading zero bytes followed by the remaining low-order bytes.
+namespace {
+const char          HeaderMagic[9] = "SimTKtrj";
+const char          FooterMagic[9] = "SimTKidx";
+const std::uint32_t FormatVersion  = 1;
+const std::uint32_t CompressedFlag = 1;
+const std::size_t   HeaderBytes    = 8 + 7*4 + 8;
+const std::size_t   IndexEntryBytes= 3*8;
+const std::size_t   FooterBytes    = 3*8 + 8;
+
+template <class T> void writePOD(std::ostream& out, const T& x)
+{   out.write(reinterpret_cast<const char*>(&x), sizeof(T)); }
+
+template <class T> T readPOD(const char* p)
+{   T x; std::memcpy(&x, p, sizeof(T)); return x; }
+
+std::uint64_t toBits(double x)
+{   std::uint64_t b; std::memcpy(&b, &x, 8); return b; }
+double fromBits(std::uint64_t b)
+{   double x; std::memcpy(&x, &b, 8); return x; }
+
+// Encode nRec records of the given width, appending to out.
+void encodeRecords(const double* values, int nRec, int width,
+                   Array_<char>& out) {
+    Array_<std::uint64_t> prev(width, 0);
+    for (int r=0; r < nRec; ++r) {
+        for (int j=0; j < width; ++j) {
+            const std::uint64_t bits = toBits(values[r*width+j]);
+            std::uint64_t x = bits ^ prev[j];
+            prev[j] = bits;
+            int nBytes = 0;
+            for (std::uint64_t y=x; y; y >>= 8) ++nBytes;
+            out.push_back(char(8-nBytes)); // leading zero bytes
+            for (int k=0; k < nBytes; ++k, x >>= 8)
+                out.push_back(char(x & 0xff));
+        }
+    }
+}
+
+// Decode nRec records of the given width from in, which must hold exactly
+// what encodeRecords() wrote.
+void decodeRecords(const char* in, int nRec, int width, double* values) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(in);
+    for (int r=0; r < nRec; ++r) {
+        for (int j=0; j < width; ++j) {
+            const int nBytes = 8 - *p++;
+            std::uint64_t x = 0;
+            for (int k=0; k < nBytes; ++k)
+                x |= std::uint64_t(*p++) << (8*k);
+            const std::uint64_t prev = r ? toBits(values[(r-1)*width+j]) : 0;
+            values[r*width+j] = fromBits(x ^ prev);
+        }
+    }
+}
+}
+
+
+
+//==============================================================================
+//                          TRAJECTORY REPORTER REP
+//==============================================================================
+class TrajectoryReporter::TrajectoryReporterRep {
+public:
+    TrajectoryReporterRep(const System& system, const std::string& fileName,
+                          bool compress)
+    :   system(system), fileName(fileName), compress(compress) {
+        out.open(fileName.c_str(), std::ios::out | std::ios::binary
+                                                 | std::ios::trunc);
+        SimTK_ERRCHK1_ALWAYS(out.good(), "TrajectoryReporter()",
+            "Couldn't open file '%s' for writing.", fileName.c_str());
+    }
+
+    ~TrajectoryReporterRep() {
+        try {close();} catch (...) {} // don't throw from a destructor
+    }
+
+    void addMeasure(const Measure& m) {
+        SimTK_ERRCHK_ALWAYS(!headerWritten && !closed,
+            "TrajectoryReporter::addMeasure()",
+            "Measures must be added before the first sample is recorded.");
+        measures.push_back(m);
+    }
+
+    void setSamplesPerChunk(int n) {
+        SimTK_ERRCHK1_ALWAYS(n > 0, "TrajectoryReporter::setSamplesPerChunk()",
+            "The number of samples per chunk must be positive but was %d.", n);
+        SimTK_ERRCHK_ALWAYS(!headerWritten && !closed,
+            "TrajectoryReporter::setSamplesPerChunk()",
+            "This must be called before the first sample is recorded.");
+        samplesPerChunk = n;
+    }
+
+    void record(const State& state) {
+        SimTK_ERRCHK1_ALWAYS(!closed, "TrajectoryReporter::handleEvent()",
+            "File '%s' has already been closed.", fileName.c_str());
+        if (!headerWritten)
+            writeHeader(state.getNQ(), state.getNU(), state.getNZ());
+        SimTK_ERRCHK_ALWAYS(   state.getNQ()==nq && state.getNU()==nu
+                            && state.getNZ()==nz,
+            "TrajectoryReporter::handleEvent()",
+            "The number of q's, u's, or z's changed during recording.");
+
+        times.push_back(state.getTime());
+        const Vector& y = state.getY(); // q, u, z
+        for (int i=0; i < y.size(); ++i)
+            values.push_back(y[i]);
+        for (const Measure& m : measures)
+            values.push_back(m.getValue(state));
+        ++numSamples;
+
+        if ((int)times.size() == samplesPerChunk)
+            writeChunk();
+    }
+
+    void close() {
+        if (closed) return;
+        if (!headerWritten) writeHeader(0, 0, 0);
+        if (!times.empty()) writeChunk();
+
+        const std::uint64_t indexOffset = out.tellp();
+        for (const IndexEntry& e : index) {
+            writePOD(out, e.offset);
+            writePOD(out, e.firstSample);
+            writePOD(out, e.firstTime);
+        }
+        writePOD(out, indexOffset);
+        writePOD(out, std::uint64_t(index.size()));
+        writePOD(out, std::uint64_t(numSamples));
+        out.write(FooterMagic, 8);
+        out.close();
+        closed = true;
+        SimTK_ERRCHK1_ALWAYS(!out.fail(), "TrajectoryReporter::close()",
+            "Error while writing file '%s'.", fileName.c_str());
+    }
+
+    int getNumSamples() const {return numSamples;}
+
+private:
+    struct IndexEntry {
+        std::uint64_t   offset, firstSample;
+        double          firstTime;
+    };
+
+    void writeHeader(int nqIn, int nuIn, int nzIn) {
+        nq = nqIn; nu = nuIn; nz = nzIn;
+        out.write(HeaderMagic, 8);
+        writePOD(out, FormatVersion);
+        writePOD(out, std::uint32_t(compress ? CompressedFlag : 0));
+        writePOD(out, std::uint32_t(nq));
+        writePOD(out, std::uint32_t(nu));
+        writePOD(out, std::uint32_t(nz));
+        writePOD(out, std::uint32_t(measures.size()));
+        writePOD(out, std::uint32_t(samplesPerChunk));
+        writePOD(out, double(1));
+        headerWritten = true;
+    }
+
+    void writeChunk() {
+        const int n = (int)times.size();
+        const int width = nq + nu + nz + (int)measures.size();
+        IndexEntry e;
+        e.offset      = out.tellp();
+        e.firstSample = numSamples - n;
+        e.firstTime   = times.front();
+        index.push_back(e);
+
+        const char* payload = reinterpret_cast<const char*>(values.cbegin());
+        std::size_t payloadBytes = values.size()*sizeof(double);
+        if (compress) {
+            encoded.clear();
+            encodeRecords(values.cbegin(), n, width, encoded);
+            payload = encoded.cbegin();
+            payloadBytes = encoded.size();
+        }
+        writePOD(out, std::uint32_t(n));
+        writePOD(out, std::uint32_t(payloadBytes));
+        out.write(reinterpret_cast<const char*>(times.cbegin()),
+                  n*sizeof(double));
+        out.write(payload, payloadBytes);
+        SimTK_ERRCHK1_ALWAYS(out.good(), "TrajectoryReporter::handleEvent()",
+            "Error while writing file '%s'.", fileName.c_str());
+
+        times.clear(); values.clear();
+    }
+
+    const System&       system;
+    const std::string   fileName;
+    const bool          compress;
+    int                 samplesPerChunk = 256;
+    Array_<Measure>     measures;
+
+    std::ofstream       out;
+    bool                headerWritten = false, closed = false;
+    int                 nq = 0, nu = 0, nz = 0;
+    int                 numSamples = 0;
+
+    // The chunk being accumulated.
+    Array_<double>      times, values;
+    Array_<char>        encoded;
+    Array_<IndexEntry>  index;
+};
+
+
+
+//==============================================================================
+//                           TRAJECTORY REPORTER
+//==============================================================================
+TrajectoryReporter::TrajectoryReporter(const System& system,
+                                       const std::string& fileName,
+                                       Real reportInterval, bool compress)
+:   PeriodicEventReporter(reportInterval),
+    rep(new TrajectoryReporterRep(system, fileName, compress)) {}
+
+TrajectoryReporter::~TrajectoryReporter() {delete rep;}
+
+void TrajectoryReporter::addMeasure(const Measure& measure)
+{   updRep().addMeasure(measure); }
+void TrajectoryReporter::setSamplesPerChunk(int n)
+{   updRep().setSamplesPerChunk(n); }
+void TrajectoryReporter::close() {updRep().close();}
+int TrajectoryReporter::getNumSamples() const
+{   return getRep().getNumSamples(); }
+
+void TrajectoryReporter::handleEvent(const State& state) const
+{   updRep().record(state); }
+
+
+
+//==============================================================================
+//                           TRAJECTORY READER REP
+//==============================================================================
+class TrajectoryReader::TrajectoryReaderRep {
+public:
+    explicit TrajectoryReaderRep(const std::string& fileName) {
+        mapFile(fileName);
+        try {readHeaderAndIndex(fileName);}
+        catch (...) {unmapFile(); throw;}
+    }
+    ~TrajectoryReaderRep() {unmapFile();}
+
+    int getNumSamples() const {return numSamples;}
+    int getWidth() const {return nq + nu + nz + nMeasures;}
+
+    Real getTime(int i) const {
+        const int c = findChunk(i);
+        const char* times = data + chunks[c].offset + 8;
+        return readPOD<double>(times + (i - chunks[c].firstSample)*8);
+    }
+
+    int findSample(Real t) const {
+        // Find the last chunk starting before t, then search its times.
+        int lo = 0, hi = (int)chunks.size();
+        while (hi - lo > 1) {
+            const int mid = (lo + hi) / 2;
+            if (chunks[mid].firstTime < t) lo = mid; else hi = mid;
+        }
+        for (int c = lo; c < (int)chunks.size(); ++c) {
+            const int n = getChunkSize(c);
+            const char* times = data + chunks[c].offset + 8;
+            for (int k=0; k < n; ++k)
+                if (readPOD<double>(times + 8*k) >= t)
+                    return chunks[c].firstSample + k;
+        }
+        return numSamples;
+    }
+
+    // Return a pointer to the decoded values of sample i (not including the
+    // time). The pointer is good until the next call.
+    const double* getValues(int i) const {
+        const int c = findChunk(i);
+        if (c != decodedChunk) decodeChunk(c);
+        return decoded.cbegin() + (i - chunks[c].firstSample)*getWidth();
+    }
+
+    int nq = 0, nu = 0, nz = 0, nMeasures = 0;
+
+private:
+    struct ChunkInfo {
+        std::uint64_t   offset;
+        int             firstSample;
+        double          firstTime;
+    };
+
+    void checkIndex(int i) const {
+        SimTK_INDEXCHECK_ALWAYS(i, numSamples, "TrajectoryReader");
+    }
+
+    int findChunk(int i) const {
+        checkIndex(i);
+        const int c = i / samplesPerChunk; // all chunks but the last are full
+        assert(chunks[c].firstSample <= i);
+        return c;
+    }
+
+    int getChunkSize(int c) const
+    {   return readPOD<std::uint32_t>(data + chunks[c].offset); }
+
+    void decodeChunk(int c) const {
+        const char* p = data + chunks[c].offset;
+        const int n = readPOD<std::uint32_t>(p);
+        const std::size_t payloadBytes = readPOD<std::uint32_t>(p + 4);
+        const char* payload = p + 8 + 8*n;
+        decoded.resize(n*getWidth());
+        if (compressed)
+            decodeRecords(payload, n, getWidth(), decoded.begin());
+        else if (payloadBytes)
+            std::memcpy(decoded.begin(), payload, payloadBytes);
+        decodedChunk = c;
+    }
+
+    void readHeaderAndIndex(const std::string& fileName) {
+        const char* where = "TrajectoryReader()";
+        SimTK_ERRCHK1_ALWAYS(size >= HeaderBytes + FooterBytes
+                             && std::memcmp(data, HeaderMagic, 8) == 0, where,
+            "File '%s' is not a trajectory file.", fileName.c_str());
+        const char* footer = data + size - FooterBytes;
+        SimTK_ERRCHK1_ALWAYS(std::memcmp(footer + 24, FooterMagic, 8) == 0,
+            where, "Trajectory file '%s' is incomplete; it must be closed "
+            "after recording.", fileName.c_str());
+
+        const char* p = data + 8;
+        const std::uint32_t version = readPOD<std::uint32_t>(p);
+        SimTK_ERRCHK2_ALWAYS(version == FormatVersion, where,
+            "Trajectory file '%s' has format version %u which this "
+            "version of Simbody can't read.", fileName.c_str(), version);
+        compressed = (readPOD<std::uint32_t>(p+4) & CompressedFlag) != 0;
+        nq              = readPOD<std::uint32_t>(p+8);
+        nu              = readPOD<std::uint32_t>(p+12);
+        nz              = readPOD<std::uint32_t>(p+16);
+        nMeasures       = readPOD<std::uint32_t>(p+20);
+        samplesPerChunk = readPOD<std::uint32_t>(p+24);
+        SimTK_ERRCHK1_ALWAYS(readPOD<double>(p+28) == 1, where,
+            "Trajectory file '%s' was written on a machine with a "
+            "different byte order.", fileName.c_str());
+
+        const std::uint64_t indexOffset = readPOD<std::uint64_t>(footer);
+        const std::uint64_t nChunks     = readPOD<std::uint64_t>(footer+8);
+        numSamples = (int)readPOD<std::uint64_t>(footer+16);
+        SimTK_ERRCHK1_ALWAYS(
+            indexOffset + nChunks*IndexEntryBytes + FooterBytes == size,
+            where, "Trajectory file '%s' is corrupt.", fileName.c_str());
+
+        chunks.resize((unsigned)nChunks);
+        for (unsigned c=0; c < chunks.size(); ++c) {
+            const char* e = data + indexOffset + c*IndexEntryBytes;
+            chunks[c].offset      = readPOD<std::uint64_t>(e);
+            chunks[c].firstSample = (int)readPOD<std::uint64_t>(e+8);
+            chunks[c].firstTime   = readPOD<double>(e+16);
+        }
+    }
+
+    #ifdef _WIN32
+    void mapFile(const std::string& fileName) {
+        file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                           NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        SimTK_ERRCHK1_ALWAYS(file != INVALID_HANDLE_VALUE,
+            "TrajectoryReader()", "Couldn't open file '%s'.",
+            fileName.c_str());
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        size = (std::size_t)fileSize.QuadPart;
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping)
+            data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0,0,0);
+        if (!data) {
+            unmapFile();
+            SimTK_ERRCHK1_ALWAYS(false, "TrajectoryReader()",
+                "Couldn't map file '%s'.", fileName.c_str());
+        }
+    }
+    void unmapFile() {
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        data = nullptr; mapping = NULL; file = INVALID_HANDLE_VALUE;
+    }
+    HANDLE file = INVALID_HANDLE_VALUE, mapping = NULL;
+    #else
+    void mapFile(const std::string& fileName) {
+        const int fd = open(fileName.c_str(), O_RDONLY);
+        SimTK_ERRCHK1_ALWAYS(fd >= 0, "TrajectoryReader()",
+            "Couldn't open file '%s'.", fileName.c_str());
+        struct stat st;
+        void* p = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            size = (std::size_t)st.st_size;
+            p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd); // the mapping keeps the file open
+        SimTK_ERRCHK1_ALWAYS(p != MAP_FAILED, "TrajectoryReader()",
+            "Couldn't map file '%s'.", fileName.c_str());
+        data = static_cast<const char*>(p);
+    }
+    void unmapFile() {
+        if (data) munmap(const_cast<char*>(data), size);
+        data = nullptr;
+    }
+    #endif
+
+    const char*         data = nullptr;
+    std::size_t         size = 0;
+
+    bool                compressed = false;
+    int                 samplesPerChunk = 1;
+    int                 numSamples = 0;
+    Array_<ChunkInfo>   chunks;
+
+    // The most recently decoded chunk.
+    mutable Array_<double>  decoded;
+    mutable int             decodedChunk = -1;
+};
+
+
+
+//==============================================================================
+//                             TRAJECTORY READER
+//==============================================================================
+TrajectoryReader::TrajectoryReader(const std::string& fileName)
+:   rep(new TrajectoryReaderRep(fileName)) {}
+
+TrajectoryReader::~TrajectoryReader() {delete rep;}
+
+int TrajectoryReader::getNumSamples()  const {return getRep().getNumSamples();}
+int TrajectoryReader::getNumQ()        const {return getRep().nq;}
+int TrajectoryReader::getNumU()        const {return getRep().nu;}
+int TrajectoryReader::getNumZ()        const {return getRep().nz;}
+int TrajectoryReader::getNumMeasures() const {return getRep().nMeasures;}
+
+Real TrajectoryReader::getTime(int i) const {return getRep().getTime(i);}
+int TrajectoryReader::findSample(Real t) const {return getRep().findSample(t);}
+
+void TrajectoryReader::fillState(int i, State& state) const {
+    const TrajectoryReaderRep& r = getRep();
+    SimTK_ERRCHK_ALWAYS(   state.getNQ()==r.nq && state.getNU()==r.nu
+                        && state.getNZ()==r.nz,
+        "TrajectoryReader::fillState()",
+        "The State doesn't have the same number of q's, u's, and z's as "
+        "the recorded trajectory.");
+    const double* y = r.getValues(i);
+    state.setTime(r.getTime(i));
+    Vector& stateY = state.updY();
+    for (int k=0; k < stateY.size(); ++k)
+        stateY[k] = y[k];
+}
+
+void TrajectoryReader::getMeasureValues(int i, Vector& values) const {
+    const TrajectoryReaderRep& r = getRep();
+    const double* v = r.getValues(i) + r.nq + r.nu + r.nz;
+    values.resize(r.nMeasures);
+    for (int k=0; k < r.nMeasures; ++k)
+        values[k] = v[k];
+}
+
+void TrajectoryReader::getSample(int i, Vector& sample) const {
+    const TrajectoryReaderRep& r = getRep();
+    const int width = r.getWidth();
+    const double* v = r.getValues(i);
+    sample.resize(1 + width);
+    sample[0] = r.getTime(i);
+    for (int k=0; k < width; ++k)
+        sample[1+k] = v[k];
+}
@@ -0,0 +1,100 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that CPodesIntegrator's sparse Jacobian mode gets the same answer as
+// the dense one on a stiff system made of many loosely coupled parts, while
+// realizing the System fewer times.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// Pairs of bodies hung from Ground on stiff damped springs, with a softer
+// spring joining the two bodies of each pair. Each pair is independent of
+// the others.
+static void buildSystem(MultibodySystem& system,
+                        GeneralForceSubsystem& forces, int nPairs) {
+    SimbodyMatterSubsystem& matter = system.updMatterSubsystem();
+    Force::Gravity(forces, matter, -YAxis, 9.81);
+    const Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    for (int p=0; p < nPairs; ++p) {
+        MobilizedBody::Translation a(matter.updGround(), Vec3(3*p,0,0),
+                                     body, Vec3(0));
+        MobilizedBody::Translation b(matter.updGround(), Vec3(3*p+1,0,0),
+                                     body, Vec3(0));
+        for (const MobilizedBody& mb : {a, b}) {
+            Force::TwoPointLinearSpring(forces, matter.updGround(),
+                mb.getDefaultInboardFrame().p(), mb, Vec3(0), 1e4, .5);
+            for (int i=0; i < 3; ++i)
+                Force::MobilityLinearDamper(forces, mb, MobilizerUIndex(i), 5);
+        }
+        Force::TwoPointLinearSpring(forces, a, Vec3(0), b, Vec3(0), 10, 1.2);
+    }
+}
+
+void testSparseMatchesDense() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildSystem(system, forces, 10);
+    system.realizeTopology();
+
+    State initState = system.getDefaultState();
+    Random::Uniform random(-.1, .1);
+    for (int i=0; i < initState.getNQ(); ++i)
+        initState.updQ()[i] = random.getValue();
+
+    State final[2];
+    int nRealizations[2];
+    for (int sparse=0; sparse < 2; ++sparse) {
+        CPodesIntegrator integ(system, CPodes::BDF);
+        integ.setAccuracy(1e-6);
+        integ.setUseSparseJacobian(sparse == 1);
+        const int n0 = system.getNumRealizationsOfThisStage(Stage::Acceleration);
+        TimeStepper ts(system, integ);
+        ts.initialize(initState);
+        ts.stepTo(2);
+        nRealizations[sparse] =
+            system.getNumRealizationsOfThisStage(Stage::Acceleration) - n0;
+        final[sparse] = integ.getState();
+        cout << (sparse ? "sparse" : "dense ") << ": "
+             << integ.getNumStepsTaken() << " steps, " << nRealizations[sparse]
+             << " realizations" << endl;
+    }
+
+    SimTK_TEST_EQ_TOL(final[0].getQ(), final[1].getQ(), 1e-4);
+    SimTK_TEST_EQ_TOL(final[0].getU(), final[1].getU(), 1e-3);
+    // Each dense Jacobian costs 120 realizations; a sparse one only 7 once
+    // the pattern has been found.
+    SimTK_TEST(nRealizations[1] < nRealizations[0]);
+}
+
+int main() {
+    SimTK_START_TEST("TestCPodesSparseJacobian");
+        SimTK_SUBTEST(testSparseMatchesDense);
+    SimTK_END_TEST();
+}
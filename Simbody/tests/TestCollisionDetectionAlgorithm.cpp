@@ -148,6 +148,74 @@ void testSphereSphere() {
     }
 }
 
+// Check that exactly the pairs of spheres at pos[] that overlap were found.
+static void checkSphereContacts(const GeneralContactSubsystem& contacts, 
+                                const State& state, ContactSetIndex setIndex, 
+                                const Array_<Vec3>& pos, Real radius) {
+    const int numBodies = (int)pos.size();
+    set<pair<int,int> > found;
+    const Array_<Contact>& contact = contacts.getContacts(state, setIndex);
+    for (int i = 0; i < (int) contact.size(); i++) {
+        int body1 = contact[i].getSurface1(), body2 = contact[i].getSurface2();
+        ASSERT(found.insert(make_pair(min(body1,body2), max(body1,body2))).second);
+    }
+    int expectedContacts = 0;
+    for (int i = 0; i < numBodies; i++)
+        for (int j = i+1; j < numBodies; j++)
+            if ((pos[i]-pos[j]).norm() < 2*radius) {
+                ASSERT(found.count(make_pair(i,j)) == 1);
+                expectedContacts++;
+            }
+    ASSERT((int)contact.size() == expectedContacts);
+}
+
+// Many spheres piled up along a line, moving a little at a time so that the
+// broad phase reuses its sorted order. Every overlapping pair must be found.
+// A second State whose spheres are scattered anew each time is realized in
+// between; each State keeps its own order so that doesn't disturb the first.
+void testManySpheresMovingCoherently() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralContactSubsystem contacts(system);
+    const int numBodies = 300;
+    const Real radius = 0.1;
+    Random::Uniform random(0.0, 1.0);
+    Body::Rigid body(MassProperties(1.0, Vec3(0), Inertia(1)));
+    ContactSetIndex setIndex = contacts.createContactSet();
+    Array_<MobilizedBody::Translation> spheres;
+    for (int i = 0; i < numBodies; ++i) {
+        spheres.push_back(MobilizedBody::Translation(matter.updGround(), body));
+        contacts.addBody(setIndex, spheres.back(), 
+                         ContactGeometry::Sphere(radius), Transform());
+    }
+    State state = system.realizeTopology();
+    State scattered = state;
+    Array_<Vec3> pos(numBodies), vel(numBodies), scatteredPos(numBodies);
+    for (int i = 0; i < numBodies; ++i) {
+        pos[i] = Vec3(random.getValue(), 20*random.getValue(), 
+                      random.getValue());
+        vel[i] = Vec3(random.getValue(), random.getValue(), 
+                      random.getValue()) - 0.5;
+    }
+    for (int iteration = 0; iteration < 20; ++iteration) {
+        for (int i = 0; i < numBodies; ++i) {
+            pos[i] += 0.01*vel[i];
+            spheres[i].setQToFitTranslation(state, pos[i]);
+        }
+        system.realize(state, Stage::Dynamics);
+        checkSphereContacts(contacts, state, setIndex, pos, radius);
+
+        for (int i = 0; i < numBodies; ++i) {
+            scatteredPos[i] = Vec3(random.getValue(), 20*random.getValue(), 
+                                   random.getValue());
+            spheres[i].setQToFitTranslation(scattered, scatteredPos[i]);
+        }
+        system.realize(scattered, Stage::Dynamics);
+        checkSphereContacts(contacts, scattered, setIndex, scatteredPos, 
+                            radius);
+    }
+}
+
 void testHalfSpaceEllipsoid() {
     MultibodySystem system;
     SimbodyMatterSubsystem matter(system);
@@ -536,6 +604,7 @@ int main() {
     try {
         testHalfSpaceSphere();
         testSphereSphere();
+        testManySpheresMovingCoherently();
         testHalfSpaceEllipsoid();
         testEllipsoidEllipsoid();
         testHalfSpaceTriangleMesh();
@@ -130,6 +130,59 @@ void testForces() {
     }
 }
 
+// Two overlapping sphere meshes, fine enough that the nearest point queries
+// are split among threads. The forces must not depend on the number of threads
+// or on the nearest face guesses left behind by earlier evaluations.
+void testMeshOnMeshThreads() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralContactSubsystem contacts(system);
+    GeneralForceSubsystem forces(system);
+
+    Body::Rigid body(MassProperties(1.0, Vec3(0), Inertia(1)));
+    ContactSetIndex setIndex = contacts.createContactSet();
+    MobilizedBody::Translation ball(matter.updGround(), Transform(), body, Transform());
+    const PolygonalMesh sphere = PolygonalMesh::createSphereMesh(1, 4);
+    contacts.addBody(setIndex, ball, ContactGeometry::TriangleMesh(sphere), Transform());
+    contacts.addBody(setIndex, matter.updGround(), ContactGeometry::TriangleMesh(sphere), Transform());
+    ElasticFoundationForce ef(forces, contacts, setIndex);
+    ef.setBodyParameters(ContactSurfaceIndex(0), 1e6, 0.01, 0.1, 0.05, 0.01);
+    ef.setBodyParameters(ContactSurfaceIndex(1), 1e6, 0.01, 0.1, 0.05, 0.01);
+    ASSERT(ef.getNumberOfThreads() == 1);
+    State state = system.realizeTopology();
+
+    const int numSteps = 14;
+    Array_<Vector_<SpatialVec> > serialForces(numSteps);
+    Array_<Real> serialEnergy(numSteps);
+    for (int k = 0; k < numSteps; ++k) {
+        const Real x = 1.9-0.1*k;
+        ball.setQToFitTranslation(state, Vec3(x, 0.1*x, 0));
+        ball.setUToFitLinearVelocity(state, Vec3(-1, 0.5, 0));
+        system.realize(state, Stage::Dynamics);
+        serialForces[k] = system.getRigidBodyForces(state, Stage::Dynamics);
+        serialEnergy[k] = system.calcPotentialEnergy(state);
+    }
+    ASSERT(serialEnergy.back() > 0);
+
+    ef.setNumberOfThreads(4);
+    ASSERT(ef.getNumberOfThreads() == 4);
+    state = system.realizeTopology();
+    // Go backwards so that the guesses come from the other neighbor.
+    for (int k = numSteps-1; k >= 0; --k) {
+        const Real x = 1.9-0.1*k;
+        ball.setQToFitTranslation(state, Vec3(x, 0.1*x, 0));
+        ball.setUToFitLinearVelocity(state, Vec3(-1, 0.5, 0));
+        system.realize(state, Stage::Dynamics);
+        const Vector_<SpatialVec>& f = 
+            system.getRigidBodyForces(state, Stage::Dynamics);
+        for (int b = 0; b < f.size(); ++b) {
+            assertEqual(f[b][0], serialForces[k][b][0]);
+            assertEqual(f[b][1], serialForces[k][b][1]);
+        }
+        assertEqual(system.calcPotentialEnergy(state), serialEnergy[k]);
+    }
+}
+
 /**
  * @brief This test compares the numerical result of a sphere
  *        in contact with a plane, using the elastic foundation
@@ -269,6 +322,7 @@ void testEffSphereOnPlaneNewFormulation(bool verbose = false)
 int main() {
     try {
         testForces();
+        testMeshOnMeshThreads();
         testEffSphereOnPlaneOldFormulation();
         testEffSphereOnPlaneNewFormulation();
     }
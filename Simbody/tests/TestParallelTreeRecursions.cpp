@@ -0,0 +1,120 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that the level-parallel tree recursions in SimbodyMatterSubsystem
+// produce exactly the same answers as the serial ones. Each node does the
+// same arithmetic in either case so we expect bitwise-identical results.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// A bushy tree: several branches off Ground, each of which forks at every
+// level so that the deeper levels have many bodies in them.
+static void buildBushyTree(SimbodyMatterSubsystem& matter,
+                           MobilizedBody& parent, int depth)
+{
+    if (depth == 0) return;
+    const Body::Rigid body(MassProperties(1, Vec3(.1,.2,.3),
+                                          UnitInertia(1.1,1.2,1.3)));
+    MobilizedBody::Ball ball(parent, Vec3(0,-1,0), body, Vec3(0,1,0));
+    MobilizedBody::Pin  pin (parent, Vec3(0,-1,.5), body, Vec3(0,1,0));
+    buildBushyTree(matter, ball, depth-1);
+    buildBushyTree(matter, pin,  depth-1);
+}
+
+struct Results {
+    Vector              udot, MInvf, residual;
+    Vector_<SpatialVec> A_GB;
+};
+
+static Results calcEverything(const MultibodySystem& system, State& state) {
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    Random::Uniform rand(-1, 1); rand.setSeed(1234);
+    Vector q(state.getNQ()), u(state.getNU());
+    rand.fillArray(&q[0], q.size());
+    rand.fillArray(&u[0], u.size());
+    state.updQ() = q; state.updU() = u;
+    system.realize(state, Stage::Acceleration);
+
+    Results r;
+    r.udot = state.getUDot();
+    Vector f(state.getNU()); rand.fillArray(&f[0], f.size());
+    matter.multiplyByMInv(state, f, r.MInvf);
+    matter.calcResidualForceIgnoringConstraints(state, f,
+        Vector_<SpatialVec>(), r.udot, r.residual);
+    r.A_GB.resize(matter.getNumBodies());
+    for (MobilizedBodyIndex mbx(0); mbx < matter.getNumBodies(); ++mbx)
+        r.A_GB[mbx] = matter.getMobilizedBody(mbx).getBodyAcceleration(state);
+    return r;
+}
+
+void testParallelMatchesSerial() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity gravity(forces, matter, -YAxis, 9.81);
+    for (int i=0; i < 3; ++i)
+        buildBushyTree(matter, matter.updGround(), 5);
+    system.realizeTopology();
+    cout << "nb=" << matter.getNumBodies()
+         << " nu=" << matter.getNumMobilities() << endl;
+
+    SimTK_TEST(matter.getNumberOfThreads() == 1);
+
+    State state = system.getDefaultState();
+    const Results serial = calcEverything(system, state);
+
+    matter.setNumberOfThreads(4);
+    matter.setParallelLevelCostThreshold(0); // always go parallel
+    SimTK_TEST(matter.getNumberOfThreads() == 4);
+    SimTK_TEST(matter.getParallelLevelCostThreshold() == 0);
+
+    State pstate = system.getDefaultState();
+    const Results parallel = calcEverything(system, pstate);
+
+    SimTK_TEST_EQ(parallel.udot, serial.udot);
+    SimTK_TEST_EQ(parallel.MInvf, serial.MInvf);
+    SimTK_TEST_EQ(parallel.residual, serial.residual);
+    SimTK_TEST_EQ(parallel.A_GB, serial.A_GB);
+
+    // Back to serial.
+    matter.setNumberOfThreads(1);
+    SimTK_TEST(matter.getNumberOfThreads() == 1);
+    State sstate = system.getDefaultState();
+    const Results serial2 = calcEverything(system, sstate);
+    SimTK_TEST_EQ(serial2.udot, serial.udot);
+
+    SimTK_TEST_MUST_THROW(matter.setNumberOfThreads(0));
+    SimTK_TEST_MUST_THROW(matter.setParallelLevelCostThreshold(-1));
+}
+
+int main() {
+    SimTK_START_TEST("TestParallelTreeRecursions");
+        SimTK_SUBTEST(testParallelMatchesSerial);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,186 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2016 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+
+// Check the block-diagonal assembly and cached factorization of G M^-1 ~G
+// used to calculate constraint multipliers. The systems have several
+// independent loop-closed chains so that G M^-1 ~G has several blocks.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+#include "../src/SimbodyMatterSubsystemRep.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// A chain of pins hanging from Ground whose last body is welded back to
+// Ground by a Ball constraint. The chain moves only in the XY plane so the
+// z row of the Ball constraint is zero and its block of G M^-1 ~G is 
+// singular; it can never be Cholesky factored.
+static MobilizedBody addLoop(SimbodyMatterSubsystem& matter, Real x) {
+    const Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    MobilizedBody parent = matter.updGround();
+    for (int i=0; i < 4; ++i) {
+        MobilizedBody::Pin pin(parent, Vec3(i==0 ? x : 0,-1,0), 
+                               body, Vec3(0,1,0));
+        parent = pin;
+    }
+    Constraint::Ball(matter.updGround(), Vec3(x+.5,-3,0), 
+                     parent, Vec3(0,0,0));
+    return parent;
+}
+
+// A chain of balls hanging from Ground, bent in 3D, whose last body is 
+// connected back to Ground by a Ball constraint at its current location. The
+// Ball constraint's block of G M^-1 ~G is well conditioned.
+static MobilizedBody add3dLoop(SimbodyMatterSubsystem& matter, Real x) {
+    const Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    const Vec3 offsets[] = {Vec3(.3,.5,.2), Vec3(-.2,.5,.4), 
+                            Vec3(.4,.5,-.3), Vec3(-.1,.5,.2)};
+    MobilizedBody parent = matter.updGround();
+    Vec3 joint(x,0,0), origin;
+    for (int i=0; i < 4; ++i) {
+        MobilizedBody::Ball ball(parent, i==0 ? joint : Vec3(0,-.5,0), 
+                                 body, offsets[i]);
+        origin = joint - offsets[i];
+        joint  = origin + Vec3(0,-.5,0);
+        parent = ball;
+    }
+    Constraint::Ball(matter.updGround(), origin, parent, Vec3(0));
+    return parent;
+}
+
+// Compare the multipliers with the dense calculation and with a fresh State
+// whose factors are calculated from scratch.
+static void checkMultipliers(const MultibodySystem& system, 
+                             const State& state) {
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    Matrix G, M, GMInvGt;
+    matter.calcG(state, G);
+    matter.calcM(state, M);
+    matter.calcProjectedMInv(state, GMInvGt);
+    Matrix MInv; FactorLU(M).inverse(MInv);
+    const Matrix dense = G * MInv * ~G;
+    SimTK_TEST_EQ_SIZE(GMInvGt, dense, 10*G.ncol());
+
+    // Multipliers must satisfy the constraints at acceleration level.
+    SimTK_TEST_EQ_TOL(state.getUDotErr(), Vector(state.getNUDotErr(),0.),
+                      1e-8);
+
+    State fresh = system.getDefaultState();
+    fresh.updQ() = state.getQ(); fresh.updU() = state.getU();
+    system.realize(fresh, Stage::Acceleration);
+    SimTK_TEST_EQ_TOL(state.getMultipliers(), fresh.getMultipliers(), 1e-8);
+    SimTK_TEST_EQ_TOL(state.getUDot(), fresh.getUDot(), 1e-8);
+}
+
+// The Ball constraint blocks here are singular, one of them also has a 
+// redundant constraint, so they are solved with FactorQTZ every time. Only the
+// coupler's block can be factored and reused.
+void testProjectedMInv() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity gravity(forces, matter, -YAxis, 9.81);
+    addLoop(matter, 0);
+    addLoop(matter, 2);
+    MobilizedBody last = addLoop(matter, 4);
+    // Redundant with the Ball constraint above.
+    Constraint::PointInPlane(matter.updGround(), UnitVec3(0,0,1), 0, 
+                             last, Vec3(0));
+    // A coupler between two base bodies puts both trees in one block.
+    MobilizedBody::Pin p1(matter.updGround(), Vec3(6,0,0),
+        Body::Rigid(MassProperties(1,Vec3(0),UnitInertia(1))), Vec3(0,1,0));
+    MobilizedBody::Pin p2(matter.updGround(), Vec3(7,0,0),
+        Body::Rigid(MassProperties(1,Vec3(0),UnitInertia(1))), Vec3(0,1,0));
+    Constraint::CoordinateCoupler(matter, 
+        new Function::Linear(Vector(Vec3(1,-2,0))),
+        std::vector<MobilizedBodyIndex>{p1.getMobilizedBodyIndex(),
+                                        p2.getMobilizedBodyIndex()}, 
+        std::vector<MobilizerQIndex>{MobilizerQIndex(0), MobilizerQIndex(0)});
+    system.realizeTopology();
+
+    State state = system.getDefaultState();
+    Assembler(system).setErrorTolerance(1e-10).assemble(state);
+
+    Random::Uniform rand(-.1, .1); rand.setSeed(42);
+    const Vector q0 = state.getQ();
+    for (int trial=0; trial < 5; ++trial) {
+        Vector dq(state.getNQ()); rand.fillArray(&dq[0], dq.size());
+        state.updQ() = q0 + (trial == 0 ? Real(0) : 1e-4)*dq;
+        Vector u(state.getNU()); rand.fillArray(&u[0], u.size());
+        state.updU() = u;
+        system.realize(state, Stage::Acceleration);
+        checkMultipliers(system, state);
+    }
+}
+
+// The 3D loops' factors must be reused from one realization to the next,
+// even though another block has to be solved with FactorQTZ every time.
+void testCachedFactorsAreReused() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity gravity(forces, matter, -YAxis, 9.81);
+    add3dLoop(matter, 0);
+    add3dLoop(matter, 2);
+    addLoop(matter, 4); // singular
+    system.realizeTopology();
+
+    State state = system.getDefaultState();
+    Assembler(system).setErrorTolerance(1e-10).assemble(state);
+    system.realize(state, Stage::Acceleration);
+    checkMultipliers(system, state);
+
+    const SBProjectedMInvFactorCache& fc = 
+        matter.getRep().getProjectedMInvFactorCache(state);
+    SimTK_TEST(fc.isFactored.size() == 3);
+    int nFactored = 0;
+    for (bool f : fc.isFactored) nFactored += f;
+    SimTK_TEST(nFactored == 2);
+    const long long numFactorizations = fc.numFactorizations;
+    SimTK_TEST(numFactorizations == 2);
+
+    // Nearby configurations must be solved with the same factors.
+    Random::Uniform rand(-.1, .1); rand.setSeed(42);
+    const Vector q0 = state.getQ();
+    for (int trial=0; trial < 5; ++trial) {
+        Vector dq(state.getNQ()); rand.fillArray(&dq[0], dq.size());
+        state.updQ() = q0 + 1e-4*dq;
+        Vector u(state.getNU()); rand.fillArray(&u[0], u.size());
+        state.updU() = u;
+        system.realize(state, Stage::Acceleration);
+        checkMultipliers(system, state);
+        SimTK_TEST(matter.getRep().getProjectedMInvFactorCache(state)
+                   .numFactorizations == numFactorizations);
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestProjectedMInvFactorization");
+        SimTK_SUBTEST(testProjectedMInv);
+        SimTK_SUBTEST(testCachedFactorsAreReused);
+    SimTK_END_TEST();
+}
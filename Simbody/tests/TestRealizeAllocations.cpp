@@ -0,0 +1,176 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that once a State has been realized a few times, further realizations
+// with new t, q, and u do no heap allocation. We count allocations by
+// replacing the global operator new for this program. Also check that the
+// operators which share that scratch space can still be called concurrently
+// on the same State.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <cstdlib>
+#include <new>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+static bool countAllocations = false;
+static long numAllocations = 0;
+
+void* operator new(std::size_t sz) {
+    if (countAllocations) ++numAllocations;
+    if (void* p = std::malloc(sz ? sz : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t sz) {return operator new(sz);}
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete[](void* p) noexcept {std::free(p);}
+
+// A chain of ball-jointed links with its end tied to Ground, a nonholonomic
+// constraint on another branch, and a few forces.
+static void buildSystem(MultibodySystem& system,
+                        GeneralForceSubsystem& forces) {
+    SimbodyMatterSubsystem& matter = system.updMatterSubsystem();
+    Force::Gravity(forces, matter, -YAxis, 9.81);
+    const Body::Rigid body(MassProperties(1, Vec3(.1,-.5,0),
+                                          UnitInertia(.3,.1,.3)));
+    MobilizedBody::Pin first(matter.updGround(), Vec3(0), body, Vec3(0,1,0));
+    Force::MobilityLinearSpring(forces, first, MobilizerQIndex(0), 10, 0);
+    MobilizedBody link = first;
+    for (int i=0; i < 5; ++i)
+        link = MobilizedBody::Ball(link, Vec3(0,-1,0), body, Vec3(0,1,0));
+    Constraint::Ball(matter.updGround(), Vec3(1,-3,0), link, Vec3(0,-1,0));
+
+    MobilizedBody::Slider slider(matter.updGround(), Vec3(5,0,0), 
+                                 body, Vec3(0));
+    MobilizedBody::Pin wheel(slider, Vec3(0), body, Vec3(0));
+    Constraint::ConstantSpeed(wheel, 1);
+    Force::TwoPointLinearSpring(forces, slider, Vec3(0), link, Vec3(0), 
+                                2, 1);
+}
+
+void testRealizeDoesNotAllocate() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildSystem(system, forces);
+    system.realizeTopology();
+
+    State state = system.getDefaultState();
+    Random::Uniform rand(-.5, .5); rand.setSeed(5);
+    for (int i=0; i < state.getNQ(); ++i) state.updQ()[i] = rand.getValue();
+    Assembler(system).assemble(state);
+
+    // Warm up so that the scratch space reaches its steady-state size.
+    Vector q = state.getQ(), u = state.getU();
+    for (int i=0; i < 3; ++i) {
+        state.updTime() += .001;
+        state.updU() = u; state.updU()[0] += .01*i;
+        system.realize(state, Stage::Acceleration);
+    }
+
+    countAllocations = true; numAllocations = 0;
+    for (int i=0; i < 100; ++i) {
+        state.updTime() += .001;
+        state.updQ()[0] = q[0] + 1e-4*i;
+        state.updU()[0] = u[0] + 1e-3*i;
+        system.realize(state, Stage::Acceleration);
+    }
+    countAllocations = false;
+    cout << "allocations during realize(): " << numAllocations << endl;
+    SimTK_TEST(numAllocations == 0);
+
+    // Sanity check: the accelerations still satisfy the constraints.
+    SimTK_TEST(state.getUDotErr().normInf() < 1e-8);
+
+    // Operators that realization uses.
+    Vector f(state.getNU(), Real(1)), MInvf;
+    matter.multiplyByMInv(state, f, MInvf);
+    countAllocations = true; numAllocations = 0;
+    for (int i=0; i < 10; ++i)
+        matter.multiplyByMInv(state, f, MInvf);
+    countAllocations = false;
+    SimTK_TEST(numAllocations == 0);
+}
+
+// Several threads apply M^-1 and ~G, and calculate tree accelerations, with
+// the same const State at once; each must get the answer it would have 
+// gotten alone.
+void testConcurrentOperators() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    buildSystem(system, forces);
+    system.realizeTopology();
+
+    State state = system.getDefaultState();
+    Assembler(system).assemble(state);
+    system.realize(state, Stage::Dynamics);
+
+    const int nThreads = 4, nReps = 200;
+    const int nu = state.getNU(), m = state.getNMultipliers();
+    std::vector<Vector> f(nThreads), lambda(nThreads);
+    std::vector<Vector> MInvf(nThreads), Gtl(nThreads), udot(nThreads);
+    for (int t=0; t < nThreads; ++t) {
+        f[t] = Vector(nu, Real(t+1)); lambda[t] = Vector(m, Real(1-t));
+        matter.multiplyByMInv(state, f[t], MInvf[t]);
+        matter.multiplyByGTranspose(state, lambda[t], Gtl[t]);
+        Vector_<SpatialVec> A_GB;
+        matter.calcAccelerationIgnoringConstraints(state, f[t], 
+            Vector_<SpatialVec>(matter.getNumBodies(), SpatialVec(Vec3(0))),
+            udot[t], A_GB);
+    }
+
+    std::vector<int> numWrong(nThreads, 0);
+    std::vector<std::thread> threads;
+    for (int t=0; t < nThreads; ++t)
+        threads.emplace_back([&, t]() {
+            Vector x, y, z; Vector_<SpatialVec> A_GB;
+            const Vector_<SpatialVec> 
+                noForces(matter.getNumBodies(), SpatialVec(Vec3(0)));
+            for (int i=0; i < nReps; ++i) {
+                matter.multiplyByMInv(state, f[t], x);
+                matter.multiplyByGTranspose(state, lambda[t], y);
+                matter.calcAccelerationIgnoringConstraints(state, f[t],
+                    noForces, z, A_GB);
+                if (   (x-MInvf[t]).normInf() != 0 || (y-Gtl[t]).normInf() != 0
+                    || (z-udot[t]).normInf() != 0)
+                    ++numWrong[t];
+            }
+        });
+    for (auto& thread : threads) thread.join();
+    for (int t=0; t < nThreads; ++t)
+        SimTK_TEST(numWrong[t] == 0);
+}
+
+int main() {
+    SimTK_START_TEST("TestRealizeAllocations");
+        SimTK_SUBTEST(testRealizeDoesNotAllocate);
+        SimTK_SUBTEST(testConcurrentOperators);
+    SimTK_END_TEST();
+}
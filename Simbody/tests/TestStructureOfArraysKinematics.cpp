@@ -0,0 +1,148 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that the batched structure-of-arrays calculation of body spatial
+// inertias, mass centers, and shift matrices gives the same answers as the
+// usual body-by-body calculation done during the position sweep. The batched
+// calculation is an internal switch so we need the private header.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+#include "../src/SimbodyMatterSubsystemRep.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+struct Results {
+    Matrix              M;
+    Vector              udot;
+    Vec3                com;
+    Real                ke;
+    Vector_<SpatialVec> A_GB;
+};
+
+static Results calcEverything(const MultibodySystem& system, State& state) {
+    const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
+    Random::Uniform rand(-1, 1); rand.setSeed(4321);
+    Vector q(state.getNQ()), u(state.getNU());
+    rand.fillArray(&q[0], q.size());
+    rand.fillArray(&u[0], u.size());
+    state.updQ() = q; state.updU() = u;
+    system.realize(state, Stage::Acceleration);
+
+    Results r;
+    matter.calcM(state, r.M);
+    r.udot = state.getUDot();
+    r.com  = matter.calcSystemMassCenterLocationInGround(state);
+    r.ke   = matter.calcKineticEnergy(state);
+    r.A_GB.resize(matter.getNumBodies());
+    for (MobilizedBodyIndex mbx(0); mbx < matter.getNumBodies(); ++mbx)
+        r.A_GB[mbx] = matter.getMobilizedBody(mbx).getBodyAcceleration(state);
+    return r;
+}
+
+void testBatchedMatchesSerial() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    GeneralForceSubsystem forces(system);
+    Force::Gravity gravity(forces, matter, -YAxis, 9.81);
+
+    // A pin chain with an offset, non-diagonal inertia on every link, with 
+    // some ball, free, and weld bodies hanging off it. The welds are not 
+    // batched so this mixes the two calculations in one system.
+    const Body::Rigid body(MassProperties(1.5, Vec3(.1,.2,.3),
+                           UnitInertia(1.1,1.2,1.3, .01,.02,.03)));
+    MobilizedBody parent = matter.updGround();
+    for (int i=0; i < 20; ++i) {
+        MobilizedBody::Pin link(parent, Vec3(0,-1,0), body, Vec3(0,1,0));
+        if (i % 4 == 0) 
+            MobilizedBody::Ball(link, Vec3(1,0,0), body, Vec3(0,1,0));
+        if (i % 5 == 0) {
+            MobilizedBody::Weld weld(link, Vec3(0,0,1), body, Vec3(0));
+            MobilizedBody::Free(weld, Vec3(1,1,0), body, Vec3(0));
+        }
+        parent = link;
+    }
+    SimbodyMatterSubsystemRep& rep = matter.updRep();
+    system.realizeTopology();
+
+    SimTK_TEST(!rep.getUseStructureOfArraysKinematics());
+    State state = system.getDefaultState();
+    SimTK_TEST(!rep.getTopologyCache(state).soaKinematicsCacheIndex.isValid());
+    const Results serial = calcEverything(system, state);
+
+    // Changing the switch invalidates the topology; the workspace then gets
+    // its own cache entry.
+    rep.setUseStructureOfArraysKinematics(true);
+    system.realizeTopology();
+    SimTK_TEST(rep.getUseStructureOfArraysKinematics());
+    State bstate = system.getDefaultState();
+    SimTK_TEST(rep.getTopologyCache(bstate).soaKinematicsCacheIndex.isValid());
+    const Results batched = calcEverything(system, bstate);
+
+    // Same q's so the same transforms; compare the batched outputs directly
+    // with what the nodes computed one at a time.
+    const SBTreePositionCache& spc = rep.getTreePositionCache(state);
+    const SBTreePositionCache& bpc = rep.getTreePositionCache(bstate);
+    SimTK_TEST(!spc.jointIndependentKinematicsBatched);
+    SimTK_TEST(bpc.jointIndependentKinematicsBatched);
+    for (MobilizedBodyIndex mbx(1); mbx < matter.getNumBodies(); ++mbx) {
+        SimTK_TEST_EQ(bpc.bodyConfigInGround[mbx], spc.bodyConfigInGround[mbx]);
+        SimTK_TEST_EQ(bpc.bodyToParentShift[mbx].l(), 
+                      spc.bodyToParentShift[mbx].l());
+        SimTK_TEST_EQ(bpc.bodyCOMInGround[mbx], spc.bodyCOMInGround[mbx]);
+        const SpatialInertia& bM = bpc.bodySpatialInertiaInGround[mbx];
+        const SpatialInertia& sM = spc.bodySpatialInertiaInGround[mbx];
+        SimTK_TEST_EQ(bM.getMass(), sM.getMass());
+        SimTK_TEST_EQ(bM.getMassCenter(), sM.getMassCenter());
+        SimTK_TEST_EQ(bM.getUnitInertia().asSymMat33(), 
+                      sM.getUnitInertia().asSymMat33());
+    }
+
+    // The arithmetic is done in a different order so the results are equal
+    // only to roundoff; accelerations come from a long chain so they lose a
+    // few more digits.
+    const Real tol = 1e-10;
+    SimTK_TEST_EQ(batched.M, serial.M);
+    SimTK_TEST_EQ_TOL(batched.udot, serial.udot, tol);
+    SimTK_TEST_EQ(batched.com, serial.com);
+    SimTK_TEST_EQ(batched.ke, serial.ke);
+    SimTK_TEST_EQ_TOL(batched.A_GB, serial.A_GB, tol);
+
+    // Works together with the level-parallel sweeps.
+    matter.setNumberOfThreads(3);
+    SimTK_TEST(rep.getUseStructureOfArraysKinematics());
+    matter.setParallelLevelCostThreshold(0);
+    State pstate = system.getDefaultState();
+    const Results parallel = calcEverything(system, pstate);
+    SimTK_TEST_EQ_TOL(parallel.udot, serial.udot, tol);
+    SimTK_TEST_EQ(parallel.ke, serial.ke);
+}
+
+int main() {
+    SimTK_START_TEST("TestStructureOfArraysKinematics");
+        SimTK_SUBTEST(testBatchedMatchesSerial);
+    SimTK_END_TEST();
+}
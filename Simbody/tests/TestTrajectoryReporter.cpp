@@ -0,0 +1,163 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+// A double pendulum with a Measure that we'll record along with the state.
+struct Pendulum {
+    Pendulum() : matter(system), forces(system),
+                 wave(forces, 2., 3., .5) {
+        Force::Gravity(forces, matter, -YAxis, 9.81);
+        const Body::Rigid body(MassProperties(1, Vec3(0), Inertia(1)));
+        MobilizedBody::Ball upper(matter.updGround(), Vec3(0),
+                                  body, Vec3(0,1,0));
+        MobilizedBody::Pin lower(upper, Vec3(0,-1,0), body, Vec3(0,1,0));
+        system.realizeTopology();
+        state = system.getDefaultState();
+        upper.setQToFitRotation(state, Rotation(.5, ZAxis));
+        lower.setOneU(state, 0, 2);
+    }
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter;
+    GeneralForceSubsystem   forces;
+    Measure::Sinusoid       wave;
+    State                   state;
+};
+
+// Record samples by hand and make sure we get back exactly what was written.
+void testRoundTrip(bool compress) {
+    const std::string fileName = "TestTrajectoryReporter.trj";
+    Pendulum p;
+    RungeKuttaMersonIntegrator integ(p.system);
+    integ.initialize(p.state);
+
+    Array_<State> expected;
+    {
+        TrajectoryReporter reporter(p.system, fileName, .01, compress);
+        reporter.addMeasure(p.wave);
+        reporter.setSamplesPerChunk(16);
+        for (int i=0; i <= 100; ++i) {
+            integ.stepTo(i*.01);
+            p.system.realize(integ.getState(), Stage::Report);
+            reporter.handleEvent(integ.getState());
+            expected.push_back(integ.getState());
+        }
+        SimTK_TEST(reporter.getNumSamples() == 101);
+        // Not closed yet; the reader can't use the file.
+        SimTK_TEST_MUST_THROW(TrajectoryReader unfinished(fileName));
+    } // destructor closes the file
+
+    TrajectoryReader reader(fileName);
+    SimTK_TEST(reader.getNumSamples() == 101);
+    SimTK_TEST(reader.getNumQ() == p.state.getNQ());
+    SimTK_TEST(reader.getNumU() == p.state.getNU());
+    SimTK_TEST(reader.getNumZ() == p.state.getNZ());
+    SimTK_TEST(reader.getNumMeasures() == 1);
+
+    // Read out of order to exercise chunk switching.
+    State s = p.system.getDefaultState();
+    Vector values, sample;
+    for (int k=0; k < 101; ++k) {
+        const int i = (37*k) % 101;
+        const State& e = expected[i];
+        SimTK_TEST(reader.getTime(i) == e.getTime());
+        reader.fillState(i, s);
+        SimTK_TEST(s.getTime() == e.getTime());
+        // Exact; compression is lossless.
+        SimTK_TEST((s.getQ() - e.getQ()).normInf() == 0);
+        SimTK_TEST((s.getU() - e.getU()).normInf() == 0);
+        reader.getMeasureValues(i, values);
+        SimTK_TEST(values.size() == 1);
+        SimTK_TEST(values[0] == p.wave.getValue(e));
+        reader.getSample(i, sample);
+        SimTK_TEST(sample.size() == 1 + e.getNY() + 1);
+        SimTK_TEST(sample[0] == e.getTime());
+        SimTK_TEST((sample(1, e.getNY()) - e.getY()).normInf() == 0);
+    }
+
+    SimTK_TEST(reader.findSample(-1) == 0);
+    SimTK_TEST(reader.findSample(expected[50].getTime()) == 50);
+    SimTK_TEST(reader.findSample(expected[50].getTime() + 1e-3) == 51);
+    SimTK_TEST(reader.findSample(2) == 101);
+    SimTK_TEST_MUST_THROW(reader.getTime(101));
+
+    std::remove(fileName.c_str());
+}
+
+// The usual way: let a TimeStepper drive the reporter as an event reporter.
+void testAsEventReporter() {
+    const std::string fileName = "TestTrajectoryReporterEvents.trj";
+    Pendulum p;
+    TrajectoryReporter* reporter =
+        new TrajectoryReporter(p.system, fileName, .1);
+    p.system.addEventReporter(reporter); // takes over ownership
+    p.system.realizeTopology();
+    State state = p.system.getDefaultState();
+    state.updQ() = p.state.getQ(); state.updU() = p.state.getU();
+
+    RungeKuttaMersonIntegrator integ(p.system);
+    TimeStepper ts(p.system, integ);
+    ts.initialize(state);
+    ts.stepTo(2);
+    reporter->close();
+
+    TrajectoryReader reader(fileName);
+    SimTK_TEST(reader.getNumSamples() == 21);
+    for (int i=0; i < reader.getNumSamples(); ++i)
+        SimTK_TEST_EQ(reader.getTime(i), i*.1);
+    SimTK_TEST(reader.getNumMeasures() == 0);
+
+    // Replay the final state; it should match the integrator's.
+    State s = p.system.getDefaultState();
+    reader.fillState(20, s);
+    SimTK_TEST_EQ(s.getQ(), integ.getState().getQ());
+
+    std::remove(fileName.c_str());
+}
+
+void testNotATrajectory() {
+    const std::string fileName = "TestTrajectoryReporterGarbage.trj";
+    {   std::ofstream out(fileName.c_str());
+        out << "This is not a trajectory file, but it is long enough to "
+               "have a header and a footer." << endl; }
+    SimTK_TEST_MUST_THROW(TrajectoryReader reader(fileName));
+    std::remove(fileName.c_str());
+    SimTK_TEST_MUST_THROW(TrajectoryReader reader(fileName));
+}
+
+int main() {
+    SimTK_START_TEST("TestTrajectoryReporter");
+        SimTK_SUBTEST1(testRoundTrip, true);
+        SimTK_SUBTEST1(testRoundTrip, false);
+        SimTK_SUBTEST(testAsEventReporter);
+        SimTK_SUBTEST(testNotATrajectory);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,93 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2026 Stanford University and the Authors.           *
+ * Authors:                                                                   *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Time position kinematics with and without the batched structure-of-arrays
+// calculation of body mass properties and shift matrices, for a long pin
+// chain and for a swarm of free bodies. The batched calculation is an 
+// internal switch so this reaches into the private SimbodyMatterSubsystemRep.
+
+#include "SimTKsimbody.h"
+#include "../../src/SimbodyMatterSubsystemRep.h"
+
+#include <iostream>
+
+using namespace SimTK;
+using std::cout; using std::endl;
+
+static double timePositionKinematics(MultibodySystem& system, 
+                                     bool useSoA, int reps) {
+    SimbodyMatterSubsystem& matter = system.updMatterSubsystem();
+    matter.updRep().setUseStructureOfArraysKinematics(useSoA);
+    system.realizeTopology();
+    State state = system.getDefaultState();
+    Random::Uniform rand(-1, 1); rand.setSeed(99);
+    Vector q(state.getNQ());
+    rand.fillArray(&q[0], q.size());
+    system.realize(state, Stage::Instance);
+
+    const double start = realTime();
+    for (int i=0; i < reps; ++i) {
+        q[0] += 1e-6;
+        state.updQ() = q;
+        matter.realizePositionKinematics(state);
+    }
+    return (realTime()-start)/reps;
+}
+
+static void compare(const char* name, MultibodySystem& system) {
+    const int reps = 2000;
+    timePositionKinematics(system, false, 10); // warm up
+    const double serial  = timePositionKinematics(system, false, reps);
+    const double batched = timePositionKinematics(system, true,  reps);
+    cout << name << ": nb=" << system.getMatterSubsystem().getNumBodies()
+         << " body-by-body " << 1e6*serial << "us, batched " 
+         << 1e6*batched << "us, speedup " << serial/batched << endl;
+}
+
+int main() {
+    try {
+        const Body::Rigid body(MassProperties(1, Vec3(.1,.2,.3),
+                               UnitInertia(1.1,1.2,1.3)));
+        {   MultibodySystem system;
+            SimbodyMatterSubsystem matter(system);
+            MobilizedBody parent = matter.updGround();
+            for (int i=0; i < 500; ++i)
+                parent = MobilizedBody::Pin(parent, Vec3(0,-1,0), 
+                                            body, Vec3(0,1,0));
+            system.realizeTopology();
+            compare("pin chain", system);
+        }
+        {   MultibodySystem system;
+            SimbodyMatterSubsystem matter(system);
+            for (int i=0; i < 500; ++i)
+                MobilizedBody::Free(matter.updGround(), Vec3(i,0,0), 
+                                    body, Vec3(0));
+            system.realizeTopology();
+            compare("free swarm", system);
+        }
+    } catch (const std::exception& e) {
+        cout << "EXCEPTION: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}